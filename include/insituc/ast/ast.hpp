@@ -5,9 +5,12 @@
 #include <insituc/type_traits.hpp>
 #include <insituc/ast/tokens.hpp>
 #include <insituc/utility/head.hpp>
+#include <insituc/memory/arena.hpp>
 
 #include <boost/mpl/list.hpp>
 
+#include <experimental/optional>
+
 #include <type_traits>
 #include <utility>
 #include <tuple>
@@ -17,6 +20,7 @@
 #include <deque>
 #include <list>
 #include <set>
+#include <map>
 #include <limits>
 
 #include <cstddef>
@@ -110,6 +114,33 @@ struct is_tagged< type, std::void_t< decltype(type::tag_) > >
 template< typename type >
 constexpr bool is_tagged_v = is_tagged< type >::value;
 
+enum class backend
+{
+    interpreter,
+    jit
+};
+
+// Typed controls of [[ key = value; flag; ... ]], filled once by the parser. Options of an entry are those of its return statement,
+// the compiler records them in meta::function for the translator and the host.
+struct pragma_options
+{
+
+    std::experimental::optional< size_type > fast_math_; // 0 is strict IEEE, 1 allows exact rewritings, 2 (or absent) also allows reassociation and lowerings changing rounding
+    std::experimental::optional< bool > inline_;         // inline or noinline: calls of the entry are (not) expanded in place by the translator, absent leaves it to its size
+    std::experimental::optional< bool > vectorize_;      // hint for the host, x87 code is scalar
+    std::experimental::optional< size_type > precision_; // required number of correct significant bits, hint for the host
+    std::experimental::optional< backend > backend_;     // preferred runtime of the entry, hint for the host
+    size_type drop_ = 0;                                 // number of returned values to drop
+    std::map< string_type, string_type > unknown_ = {};  // keys not listed above, as is
+
+    size_type
+    fast_math_level() const
+    {
+        return fast_math_.value_or(2);
+    }
+
+};
+
 struct pragma
 {
 
@@ -117,6 +148,8 @@ struct pragma
 
     size_type tag_ = ntag;
 
+    pragma_options options_ = {};
+
 };
 
 struct empty
@@ -174,6 +207,12 @@ struct identifier
         return true;
     }
 
+    bool
+    is_dummy_placeholder() const // "_" discards a value
+    {
+        return (symbol_.name_ == "_") && wrts_.empty();
+    }
+
     void
     derive(symbol const & _wrt)
     {
@@ -360,6 +399,8 @@ struct unary_expression
     unary operator_;
     operand operand_;
 
+    INSITUC_ARENA_NODE
+
 };
 
 using rvalues = std::deque< rvalue >;
@@ -372,6 +413,8 @@ struct rvalue_list
 
     size_type tag_ = ntag;
 
+    INSITUC_ARENA_NODE
+
 };
 
 inline
@@ -405,6 +448,8 @@ struct expression
 
     size_type tag_ = ntag;
 
+    INSITUC_ARENA_NODE
+
 };
 
 struct binary_expression
@@ -414,6 +459,8 @@ struct binary_expression
     binary operator_;
     operand rhs_;
 
+    INSITUC_ARENA_NODE
+
 };
 
 struct intrinsic_invocation
@@ -424,6 +471,8 @@ struct intrinsic_invocation
 
     size_type tag_ = ntag;
 
+    INSITUC_ARENA_NODE
+
 };
 
 struct entry_substitution
@@ -434,6 +483,8 @@ struct entry_substitution
 
     size_type tag_ = ntag;
 
+    INSITUC_ARENA_NODE
+
 };
 
 struct variable_declaration
@@ -516,6 +567,8 @@ struct statement_block
 
     size_type tag_ = ntag;
 
+    INSITUC_ARENA_NODE
+
 };
 
 struct entry_definition
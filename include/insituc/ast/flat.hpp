@@ -0,0 +1,107 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+#include <vector>
+#include <map>
+#include <limits>
+#include <utility>
+
+#include <cstdint>
+
+namespace insituc
+{
+namespace ast
+{
+namespace flat
+{
+
+// Flat representation of evaluated ASTs (expressions are binary expression trees) for linear passes.
+// Nodes are stored column-wise and referenced by 32-bit indices. Children always precede their parents (post-order),
+// so a forward sweep over nodes visits operands before operations. Identifiers are interned, shared subtrees (operand_cptr) are stored once.
+using index = std::uint32_t;
+
+constexpr index npos = std::numeric_limits< index >::max();
+
+struct slice
+{
+
+    index first_ = 0;
+    index count_ = 0;
+
+};
+
+enum class node_kind : std::uint8_t
+{
+    value,        // payload is index in values_
+    constant,     // code is constant
+    identifier,   // payload is index in identifiers_
+    intrinsic,    // code is intrinsic, children are arguments
+    substitution, // payload is index of entry name in identifiers_, children are arguments
+    unary,        // code is unary operator, single child
+    binary,       // code is binary operator, children are lhs and rhs
+    list          // children are rvalues
+};
+
+enum class statement_kind : std::uint8_t
+{
+    declaration, // lvalues in lhs, rvalues in rhs
+    assignment,  // the same, code is assign operator
+    block        // rhs is a slice of nested_
+};
+
+struct program
+{
+
+    // operand nodes
+    std::vector< node_kind > kinds_;
+    std::vector< std::uint8_t > codes_;
+    std::vector< index > payloads_;
+    std::vector< slice > arguments_; // slices of children_
+    std::vector< index > children_;
+    std::map< index, pragma > pragmas_; // non-empty ones only
+
+    std::vector< G > values_;
+    std::vector< identifier > identifiers_;
+
+    // statements
+    std::vector< statement_kind > statement_kinds_;
+    std::vector< std::uint8_t > statement_codes_;
+    std::vector< slice > lhs_; // slices of lvalues_
+    std::vector< slice > rhs_; // slices of children_ or nested_
+    std::map< index, pragma > statement_pragmas_;
+    std::vector< index > lvalues_; // indices in identifiers_
+    std::vector< index > nested_; // statements of blocks and bodies
+
+    // entries
+    std::vector< index > names_; // indices in identifiers_
+    std::vector< slice > parameters_; // slices of lvalues_
+    std::vector< slice > bodies_; // slices of nested_
+    std::vector< slice > results_; // slices of children_
+    std::map< index, pragma > result_pragmas_;
+
+    index
+    size() const noexcept // number of nodes
+    {
+        return static_cast< index >(kinds_.size());
+    }
+
+    std::pair< index const *, index const * >
+    children(index const _node) const noexcept
+    {
+        slice const & slice_ = arguments_[_node];
+        index const * const first_ = children_.data() + slice_.first_;
+        return {first_, first_ + slice_.count_};
+    }
+
+};
+
+program
+flatten(ast::program const & _program);
+
+ast::program
+unflatten(program const & _program);
+
+}
+}
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <boost/functional/hash.hpp>
+
+#include <functional>
+
+namespace insituc
+{
+namespace ast
+{
+
+// structural hash, consistent with equality from <insituc/ast/compare.hpp>
+struct hash
+{
+
+    size_type
+    operator () (empty const & /*_empty*/) const noexcept
+    {
+        return 0;
+    }
+
+    size_type
+    operator () (G const & _value) const
+    {
+        return std::hash< F >{}(static_cast< F const & >(_value));
+    }
+
+    size_type
+    operator () (constant const _constant) const noexcept
+    {
+        return static_cast< size_type >(_constant);
+    }
+
+    size_type
+    operator () (symbol const & _symbol) const
+    {
+        return std::hash< string_type >{}(_symbol.name_);
+    }
+
+    size_type
+    operator () (identifier const & _identifier) const
+    {
+        size_type seed_ = operator () (_identifier.symbol_);
+        for (symbol const & wrt_ : _identifier.wrts_) {
+            boost::hash_combine(seed_, operator () (wrt_));
+        }
+        return seed_;
+    }
+
+    size_type
+    operator () (rvalue_list const & _rvalue_list) const
+    {
+        size_type seed_ = _rvalue_list.rvalues_.size();
+        for (rvalue const & rvalue_ : _rvalue_list.rvalues_) {
+            boost::hash_combine(seed_, operator () (rvalue_));
+        }
+        return seed_;
+    }
+
+    size_type
+    operator () (intrinsic_invocation const & _intrinsic_invocation) const
+    {
+        size_type seed_ = static_cast< size_type >(_intrinsic_invocation.intrinsic_);
+        boost::hash_combine(seed_, operator () (_intrinsic_invocation.argument_list_));
+        return seed_;
+    }
+
+    size_type
+    operator () (entry_substitution const & _entry_substitution) const
+    {
+        size_type seed_ = operator () (_entry_substitution.entry_name_);
+        boost::hash_combine(seed_, operator () (_entry_substitution.argument_list_));
+        return seed_;
+    }
+
+    size_type
+    operator () (unary_expression const & _unary_expression) const
+    {
+        size_type seed_ = static_cast< size_type >(_unary_expression.operator_);
+        boost::hash_combine(seed_, operator () (_unary_expression.operand_));
+        return seed_;
+    }
+
+    size_type
+    operator () (binary_expression const & _binary_expression) const
+    {
+        size_type seed_ = operator () (_binary_expression.lhs_);
+        boost::hash_combine(seed_, static_cast< size_type >(_binary_expression.operator_));
+        boost::hash_combine(seed_, operator () (_binary_expression.rhs_));
+        return seed_;
+    }
+
+    size_type
+    operator () (expression const & _expression) const
+    {
+        size_type seed_ = operator () (_expression.first_);
+        for (operation const & operation_ : _expression.rest_) {
+            boost::hash_combine(seed_, static_cast< size_type >(operation_.operator_));
+            boost::hash_combine(seed_, operator () (operation_.operand_));
+        }
+        return seed_;
+    }
+
+    size_type
+    operator () (operand_cptr const _operand_cptr) const
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    size_type
+    operator () (operand const & _operand) const
+    {
+        operand const & operand_ = unref(_operand);
+        if (auto const * const rvalue_list_ = get< rvalue_list >(&operand_)) {
+            if (rvalue_list_->rvalues_.size() == 1) { // parentheses are transparent for comparison
+                return operator () (rvalue_list_->rvalues_.back());
+            }
+        }
+        size_type seed_ = operand_.which();
+        boost::hash_combine(seed_, visit([&] (auto const & o) -> size_type
+        {
+            return operator () (o);
+        }, *operand_));
+        return seed_;
+    }
+
+};
+
+}
+}
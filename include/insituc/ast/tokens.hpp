@@ -3,6 +3,7 @@
 #include <insituc/base_types.hpp>
 
 #include <utility>
+#include <stdexcept>
 
 namespace insituc
 {
@@ -91,6 +92,7 @@ enum class intrinsic
     // TODO: decide about fma necessety
     chs,
     abs,
+    sign, // -1, 0 or 1 (NaN for NaN)
     twice,
     sumsqr,
     sqrt,
@@ -123,9 +125,48 @@ enum class intrinsic
     arcsin,
     arccos,
     max,
-    min
+    min,
+    pickmax, // pickmax(a_1, b_1, ..., a_n, b_n) is b_i of the first greatest a_i
+    pickmin  // pickmin(a_1, b_1, ..., a_n, b_n) is b_i of the first least a_i
 };
 
+constexpr
+size_type
+result_count(intrinsic const _intrinsic) noexcept // number of values, which intrinsic returns
+{
+    switch (_intrinsic) {
+    case intrinsic::sincos  :
+    case intrinsic::intrem  :
+    case intrinsic::fracint :
+    case intrinsic::extract : {
+        return 2;
+    }
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wswitch-enum"
+#pragma clang diagnostic ignored "-Wcovered-switch-default"
+    default : {
+        return 1;
+    }
+#pragma clang diagnostic pop
+    }
+}
+
+constexpr
+binary
+get_binary(assign const _assign) // operator of compound assignment
+{
+    switch (_assign) {
+    case assign::assign        : break;
+    case assign::plus_assign   : return binary::add;
+    case assign::minus_assign  : return binary::sub;
+    case assign::times_assign  : return binary::mul;
+    case assign::divide_assign : return binary::div;
+    case assign::mod_assign    : return binary::mod;
+    case assign::raise_assign  : return binary::pow;
+    }
+    throw std::logic_error("simple assignment has no binary operator");
+}
+
 enum class keyword
 {
     local_,
@@ -196,6 +237,7 @@ c_str(intrinsic const _intrinsic) noexcept
     switch (_intrinsic) {
     case intrinsic::chs       : return "chs";
     case intrinsic::abs       : return "abs";
+    case intrinsic::sign      : return "sign";
     case intrinsic::twice     : return "twice";
     case intrinsic::sumsqr    : return "sumsqr";
     case intrinsic::sqrt      : return "sqrt";
@@ -229,6 +271,8 @@ c_str(intrinsic const _intrinsic) noexcept
     case intrinsic::arccos    : return "arccos";
     case intrinsic::max       : return "max";
     case intrinsic::min       : return "min";
+    case intrinsic::pickmax   : return "pickmax";
+    case intrinsic::pickmin   : return "pickmin";
     }
 }
 
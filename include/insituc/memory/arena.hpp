@@ -0,0 +1,90 @@
+#pragma once
+
+#include <insituc/base_types.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <cstddef>
+
+namespace insituc
+{
+
+// Monotonic region: allocations are bumped from chunks, deallocation is a no-op, all the chunks are released at once on destruction.
+// While the arena is installed (by arena::scope) on the current thread, recursively wrapped AST nodes are allocated from it.
+// Arena should outlive all the nodes allocated from it. Nodes copied after the scope is left are allocated from the heap.
+struct arena
+{
+
+    explicit
+    arena(size_type const _chunk_size = 65536);
+
+    arena(arena const &) = delete;
+    arena & operator = (arena const &) = delete;
+
+    void *
+    allocate(size_type const _size,
+             size_type const _alignment = alignof(std::max_align_t));
+
+    size_type
+    size() const noexcept // bytes used
+    {
+        return size_;
+    }
+
+    struct scope
+    {
+
+        explicit
+        scope(arena & _arena) noexcept;
+
+        scope(scope const &) = delete;
+        scope & operator = (scope const &) = delete;
+
+        ~scope() noexcept;
+
+    private :
+
+        arena * const previous_;
+
+    };
+
+    static
+    arena *
+    current() noexcept;
+
+    // node storage is prefixed with the owning arena (or nullptr for the heap)
+    static
+    void *
+    allocate_node(std::size_t const _size);
+
+    static
+    void
+    deallocate_node(void * const _pointer) noexcept;
+
+private :
+
+    size_type const chunk_size_;
+    std::vector< std::unique_ptr< unsigned char [] > > chunks_;
+    unsigned char * top_ = nullptr;
+    size_type available_ = 0;
+    size_type size_ = 0;
+
+};
+
+}
+
+// Class-specific allocation functions of the recursively wrapped AST nodes (a base class would break their aggregate initialization).
+#define INSITUC_ARENA_NODE \
+    static \
+    void * \
+    operator new (std::size_t const _size) \
+    { \
+        return ::insituc::arena::allocate_node(_size); \
+    } \
+    static \
+    void \
+    operator delete (void * const _pointer) noexcept \
+    { \
+        ::insituc::arena::deallocate_node(_pointer); \
+    }
@@ -68,6 +68,18 @@ struct assembler
         return true;
     }
 
+    void
+    set_options(ast::pragma_options _options) // of the current function, after enter
+    {
+        monitor_.set_options(std::move(_options));
+    }
+
+    ast::pragma_options const &
+    get_options() const
+    {
+        return monitor_.options();
+    }
+
     template< typename ...assembly >
     result_type
     operator () (assembly &&... _assembly)
@@ -133,7 +145,7 @@ struct assembler
     bool
     is_dummy_placeholder(symbol_type const & _symbol) const
     {
-        return (_symbol == get_dummy_placeholder());
+        return _symbol.is_dummy_placeholder();
     }
 
     bool
@@ -209,6 +221,16 @@ struct assembler
         return heap_[_offset];
     }
 
+    std::map< symbol_type, G >
+    get_global_variables(symbol_set_type const & _symbols) const // snapshot of current values, e.g. to freeze them
+    {
+        std::map< symbol_type, G > values_;
+        for (symbol_type const & symbol_ : _symbols) {
+            values_.emplace(symbol_, get_global_variable(symbol_));
+        }
+        return values_;
+    }
+
     size_type
     get_heap_size() const
     {
@@ -265,7 +287,7 @@ struct assembler
 private :
 
     symbol_type dummy_placeholder_;
-    symbol_set_type reserved_symbols_;
+    symbol_set_type const & reserved_symbols_; // shared by all the assemblers
 
     functions_type functions_;
     symbol_mapping_type export_table_;
@@ -280,18 +302,6 @@ private :
     std::deque< size_type > brackets_;
     symbols_type local_variables_;
 
-    template< typename symbol >
-    bool
-    add_reserved_symbol(symbol && _symbol)
-    {
-        static_assert(std::is_assignable_v< string_type &, symbol >, "can't construct reserved symbol name");
-        assert(functions_.empty());
-        symbol_type reserved_symbol_;
-        reserved_symbol_.symbol_.name_ = std::forward< symbol >(_symbol);
-        assert(!is_dummy_placeholder(reserved_symbol_));
-        return reserved_symbols_.insert(std::move(reserved_symbol_)).second;
-    }
-
     template< typename symbol >
     size_type
     add_local_variable(symbol && _symbol)
@@ -599,6 +609,18 @@ private :
             return function_.leave(std::move(_symbol), std::move(_arguments));
         }
 
+        void
+        set_options(ast::pragma_options _options)
+        {
+            function_.options_ = std::move(_options);
+        }
+
+        ast::pragma_options const &
+        options() const
+        {
+            return function_.options_;
+        }
+
         operator function () &&
         {
             assert(!function_.empty());
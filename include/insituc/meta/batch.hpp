@@ -0,0 +1,28 @@
+#pragma once
+
+#include <insituc/meta/assembler.hpp>
+#include <insituc/ast/ast.hpp>
+
+#include <map>
+#include <deque>
+
+namespace insituc
+{
+namespace meta
+{
+
+using entry_table = std::map< symbol_type, size_type >; // original entry name -> function index
+using entry_tables = std::deque< entry_table >;
+
+// All the _programs are compiled into the single _assembler: they share its heap (global variables and the deduplicated literal pool)
+// and, after translation, one runtime::instance (function indices are also the indices of entry points of the instance and of the virtual machine).
+// To keep programs apart, entries of the i-th program are exported as "name#i" (calls between them are redirected accordingly),
+// substitutions of other names refer to functions compiled into the _assembler earlier. One entry table per program is appended to _entry_tables;
+// numbering continues from _entry_tables.size(), so the same _assembler and _entry_tables can be passed to repeated calls.
+bool
+compile_batch(assembler & _assembler,
+              ast::programs const & _programs,
+              entry_tables & _entry_tables);
+
+}
+}
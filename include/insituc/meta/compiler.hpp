@@ -2,10 +2,14 @@
 
 #include <insituc/meta/assembler.hpp>
 #include <insituc/type_traits.hpp>
-#include <insituc/shunting_yard_algorithm.hpp>
+#include <insituc/variant.hpp>
 
 #include <versatile/visit.hpp>
 
+#include <iterator>
+
+#include <cassert>
+
 namespace insituc
 {
 namespace meta
@@ -16,8 +20,10 @@ struct compiler
 
     using result_type = bool;
 
-    compiler(assembler & _assembler)
+    compiler(assembler & _assembler,
+             size_type const _estrin_degree = 8) // poly of higher degree is evaluated by Estrin's scheme
         : assembler_(_assembler)
+        , estrin_degree_(_estrin_degree)
         , add_ (*this, mnemocode::fadd)
         , sub_ (*this, mnemocode::fsub, mnemocode::fsubr)
         , subr_(*this, mnemocode::fsubr, mnemocode::fsub)
@@ -47,6 +53,7 @@ struct compiler
 private :
 
     assembler & assembler_;
+    size_type const estrin_degree_;
 
     template< typename type >
     result_type
@@ -106,6 +113,62 @@ private :
         return true;
     }
 
+    static constexpr difference_type reduction_width = 4; // leaves of a balanced subtree of a reduction
+
+    bool
+    reassociates() const // fast_math level 2 of the current function allows reassociation of sums and of Horner's scheme, which changes rounding
+    {
+        return (1 < assembler_.get_options().fast_math_level());
+    }
+
+    template< typename iterator, typename argument, typename combine >
+    result_type
+    reduce_balanced(iterator const _first, iterator const _last,
+                    argument const & _argument,
+                    combine const & _combine) const
+    { // at most log2(reduction_width) partial results are live while the last leaf is evaluated
+        auto const size_ = std::distance(_first, _last);
+        if (size_ == 0) {
+            return false;
+        } else if (size_ == 1) {
+            return _argument(*_first);
+        }
+        iterator const middle_ = std::next(_first, size_ / 2);
+        if (!reduce_balanced(_first, middle_, _argument, _combine)) {
+            return false;
+        }
+        if (!reduce_balanced(middle_, _last, _argument, _combine)) {
+            return false;
+        }
+        return _combine();
+    }
+
+    template< typename iterator, typename argument, typename combine >
+    result_type
+    reduce_pairwise(iterator const _first, iterator const _last,
+                    argument const & _argument,
+                    combine const & _combine,
+                    difference_type const _width = reduction_width) const
+    { // balanced subtrees shorten the dependency chain, they are folded into a single accumulator to respect the 8-register x87 stack:
+      // at most log2(_width) + 1 partial results are live while an argument is evaluated, whatever the arity is; _width 1 folds left to right
+        assert(0 < _width);
+        if (_first == _last) {
+            return false;
+        }
+        iterator block_ = _first;
+        for (bool first_ = true; block_ != _last; first_ = false) {
+            iterator const next_ = (std::distance(block_, _last) < _width) ? _last : std::next(block_, _width);
+            if (!reduce_balanced(block_, next_, _argument, _combine)) {
+                return false;
+            }
+            if (!first_ && !_combine()) {
+                return false;
+            }
+            block_ = next_;
+        }
+        return true;
+    }
+
     result_type
     compile(ast::empty const &) const
     {
@@ -327,161 +390,6 @@ private :
     arithmetic const div_;
     arithmetic const divr_;
 
-    struct tree_switch
-    {
-
-        using result_type = typename compiler::result_type;
-
-        using shunting_yard_algorithm_type = shunting_yard_algorithm< tree_switch const, false >;
-        using node_type = typename shunting_yard_algorithm_type::node_type;
-
-        tree_switch(compiler const & _compiler)
-            : compiler_(_compiler)
-            , assembler_(compiler_.assembler_)
-            , add_{compiler_.add_, compiler_.add_}
-            , sub_{compiler_.sub_, compiler_.subr_}
-            , mul_{compiler_.mul_, compiler_.mul_}
-            , div_{compiler_.div_, compiler_.divr_}
-            , rpn_(*this)
-            , operation_commutator_(rpn_)
-        { ; }
-
-        result_type
-        traverse(ast::expression const & _expression)
-        {
-            return rpn_.traverse(_expression);
-        }
-
-        result_type
-        operator () (ast::operand const & _ast) const
-        {
-            return compiler_(_ast);
-        }
-
-        result_type
-        operator () (ast::operand const & _lhs,
-                     ast::binary const _operator,
-                     ast::operand const & _rhs) const
-        {
-            return compiler_(_lhs,
-                             _operator,
-                             _rhs);
-        }
-
-        result_type
-        operator () (node_type const & _lhs,
-                     ast::binary const _operator,
-                     node_type const & _rhs) const;
-
-    private :
-
-        compiler const & compiler_;
-        assembler & assembler_;
-
-        struct anticommutative_operator
-        {
-
-            arithmetic const & forward_;
-            arithmetic const & reverse_;
-
-        };
-
-        anticommutative_operator const add_;
-        anticommutative_operator const sub_;
-        anticommutative_operator const mul_;
-        anticommutative_operator const div_;
-
-        shunting_yard_algorithm_type rpn_;
-
-        struct operation_commutator
-        {
-
-            using lhs_op_rhs = typename shunting_yard_algorithm_type::lhs_op_rhs;
-            using operand_ptr = typename shunting_yard_algorithm_type::operand_ptr;
-
-            operation_commutator(shunting_yard_algorithm_type const & _rpn)
-                : rpn_(_rpn)
-            { ; }
-
-            result_type
-            operator () (node_type const & _lhs,
-                         anticommutative_operator const & _operator,
-                         node_type const & _rhs) const
-            {
-                return multivisit([&] (auto const & l, auto const & r) -> result_type
-                {
-                    return dispatch(l, _operator, r);
-                }, _lhs, _rhs);
-            }
-
-            result_type
-            operator () (anticommutative_operator const & _operator,
-                         node_type const & _rhs) const
-            {
-                return visit([&] (auto const & r) -> result_type
-                {
-                    return dispatch(_operator, r);
-                }, _rhs);
-            }
-
-        private :
-
-            result_type
-            dispatch(lhs_op_rhs const & _lhs,
-                     anticommutative_operator const & _operator,
-                     lhs_op_rhs const & _rhs) const
-            {
-                return rpn_(_lhs) && rpn_(_rhs) && _operator.forward_();
-                // <=> return rpn_(_rhs) && rpn_(_lhs) && _operator.reverse_();
-            }
-
-            result_type
-            dispatch(lhs_op_rhs const & _lhs,
-                     anticommutative_operator const & _operator,
-                     operand_ptr const _rhs) const
-            {
-                return rpn_(_lhs) && _operator.forward_(*_rhs);
-            }
-
-            result_type
-            dispatch(operand_ptr const _lhs,
-                     anticommutative_operator const & _operator,
-                     lhs_op_rhs const & _rhs) const
-            {
-                return rpn_(_rhs) && _operator.reverse_(*_lhs);
-            }
-
-            result_type
-            dispatch(operand_ptr const _lhs,
-                     anticommutative_operator const & _operator,
-                     operand_ptr const _rhs) const
-            {
-                return _operator.forward_(*_lhs, *_rhs);
-                // <=> return _operator.reverse_(_rhs.get(), _lhs.get());
-            }
-
-            result_type
-            dispatch(anticommutative_operator const & _operator,
-                     operand_ptr const _rhs) const
-            {
-                return _operator.forward_(*_rhs);
-            }
-
-            result_type
-            dispatch(anticommutative_operator const & _operator,
-                     lhs_op_rhs const & _rhs) const
-            {
-                return rpn_(_rhs) && _operator.forward_();
-            }
-
-            shunting_yard_algorithm_type const & rpn_;
-
-        };
-
-        operation_commutator const operation_commutator_;
-
-    };
-
     result_type
     compile(ast::expression const & _expression) const
     {
@@ -493,8 +401,7 @@ private :
                                 op_rhs_.operator_,
                                 op_rhs_.operand_);
         } else {
-            tree_switch Dijkstra(*this);
-            return Dijkstra.traverse(_expression); // RPN
+            return false; // precedence is resolved once per program by compile(ast::program)
         }
     }
 
@@ -519,6 +426,7 @@ private :
 
     result_type compile_chs      (ast::rvalues const & _arguments) const;
     result_type compile_abs      (ast::rvalues const & _arguments) const;
+    result_type compile_sign     (ast::rvalues const & _arguments) const;
     result_type compile_twice    (ast::rvalues const & _arguments) const;
     result_type compile_sumsqr   (ast::rvalues const & _arguments) const;
     result_type compile_sumsqr   (ast::rvalue  const & _argument ) const;
@@ -534,6 +442,7 @@ private :
     result_type compile_arctg    (ast::rvalues const & _arguments) const;
     result_type compile_atan2    (ast::rvalues const & _arguments) const;
     result_type compile_poly     (ast::rvalues const & _arguments) const;
+    result_type compile_poly_estrin(ast::rvalues const & _arguments) const;
     result_type compile_frac     (ast::rvalues const & _arguments) const;
     result_type compile_intrem   (ast::rvalues const & _arguments) const;
     result_type compile_fracint  (ast::rvalues const & _arguments) const;
@@ -555,6 +464,7 @@ private :
     result_type compile_max      (ast::rvalue  const & _argument ) const;
     result_type compile_min      (ast::rvalues const & _arguments) const;
     result_type compile_min      (ast::rvalue  const & _argument ) const;
+    result_type compile_pick     (ast::rvalues const & _arguments, bool const _greatest) const;
 
     result_type call_intrinsic(ast::intrinsic const _intrinsic,
                                ast::rvalues const & _arguments) const;
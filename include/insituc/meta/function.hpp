@@ -30,6 +30,8 @@ struct function
     std::unordered_set< size_type > callies_;
     code_type code_;
 
+    ast::pragma_options options_; // of the return statement of the entry: fast_math for the compiler, inline for the translator
+
     void
     enter(size_type const _arity,
           size_type const _input = 0)
@@ -42,6 +44,7 @@ struct function
         input_ = _input;
         clobbered_ = input_;
         output_ = 0;
+        options_ = {};
     }
 
     void
@@ -71,6 +74,7 @@ struct function
         output_ = 0;
         callies_.clear();
         code_.clear();
+        options_ = {};
         return true;
     }
 
@@ -113,6 +117,9 @@ struct function
         if (!(code_ == _other.code_)) {
             return false;
         }
+        if ((options_.fast_math_level() != _other.options_.fast_math_level()) || (options_.inline_ != _other.options_.inline_)) {
+            return false;
+        }
         return true;
     }
 
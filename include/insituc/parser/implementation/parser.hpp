@@ -5,6 +5,8 @@
 #include <insituc/parser/skipper.hpp>
 #include <insituc/ast/adaptation.hpp>
 #include <insituc/parser/annotation.hpp>
+#include <insituc/parser/literal.hpp>
+#include <insituc/parser/pragma_parser.hpp>
 
 #include <boost/spirit/home/x3.hpp>
 
@@ -98,6 +100,7 @@ x3::symbols< ast::intrinsic > const intrinsic_
 ({
      to_pair(ast::intrinsic::chs),
      to_pair(ast::intrinsic::abs),
+     to_pair(ast::intrinsic::sign),
      to_pair(ast::intrinsic::twice),
      to_pair(ast::intrinsic::sumsqr),
      to_pair(ast::intrinsic::sqrt),
@@ -130,7 +133,9 @@ x3::symbols< ast::intrinsic > const intrinsic_
      to_pair(ast::intrinsic::arcsin),
      to_pair(ast::intrinsic::arccos),
      to_pair(ast::intrinsic::max),
-     to_pair(ast::intrinsic::min)
+     to_pair(ast::intrinsic::min),
+     to_pair(ast::intrinsic::pickmax),
+     to_pair(ast::intrinsic::pickmin)
  },
  "intrinsic");
 
@@ -188,20 +193,41 @@ get_keywords()
 namespace
 {
 
-using real_parser = x3::real_parser< G >;
+struct real_literal_parser
+        : x3::parser< real_literal_parser >
+{
+
+    using attribute_type = G;
+
+    static bool const has_attribute = true;
 
-real_parser const real_number{};
+    template< typename iterator, typename context, typename rcontext, typename attribute >
+    bool
+    parse(iterator & first, iterator const & last,
+          context const & _context, rcontext & /*_rcontext*/,
+          attribute & _attribute) const
+    {
+        x3::skip_over(first, last, _context);
+        if (auto value_ = scan_real_literal(first, last)) {
+            x3::traits::move_to(G(*value_), _attribute);
+            return true;
+        }
+        return false;
+    }
+
+};
+
+real_literal_parser const real_number{};
 
 }
 
 std::experimental::optional< G >
 parse_real_number(base_iterator_type const & first, base_iterator_type const & last)
 {
-    G ast_{};
     base_iterator_type it = first;
-    if (x3::parse(it, last, real_number, ast_)) {
+    if (auto value_ = scan_real_literal(it, last)) {
         if (it == last) {
-            return std::move(ast_);
+            return G(*value_);
         }
     }
     return {};
@@ -210,7 +236,22 @@ parse_real_number(base_iterator_type const & first, base_iterator_type const & l
 namespace
 {
 
-struct pragma_class :               error_handler_base, annotation_base {};
+struct pragma_class
+        : error_handler_base, annotation_base
+{
+
+    template< typename iterator, typename context >
+    static
+    void
+    on_success(iterator const & first, iterator const & last,
+               ast::pragma & _ast, context const & _context)
+    {
+        annotation_base::on_success(first, last, _ast, _context);
+        _ast.options_ = parse_pragma(_ast.record_); // once per pragma
+    }
+
+};
+
 struct symbol_class :               error_handler_base, annotation_base {};
 struct identifier_class :           error_handler_base, annotation_base {};
 struct operand_class :              error_handler_base, annotation_base {};
@@ -389,6 +430,12 @@ BOOST_SPIRIT_DEFINE(entry_definition,
 
 parse_result
 parse(base_iterator_type const & first, base_iterator_type const & last)
+{
+    return parse(input_iterator_type(first), input_iterator_type(last));
+}
+
+parse_result
+parse(input_iterator_type const & beg, input_iterator_type const & end)
 {
     parse_result parse_result_;
 
@@ -401,9 +448,7 @@ parse(base_iterator_type const & first, base_iterator_type const & last)
 
     auto const & skipper_ = get_skipper();
 
-    input_iterator_type const beg(first);
     input_iterator_type pos = beg;
-    input_iterator_type const end(last);
     try {
         if (x3::phrase_parse(pos, end, grammar_, skipper_, parse_result_.ast_)) {
             if (pos != end) {
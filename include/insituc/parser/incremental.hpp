@@ -0,0 +1,42 @@
+#pragma once
+
+#include <insituc/parser/parser.hpp>
+
+#include <deque>
+
+namespace insituc
+{
+namespace parser
+{
+
+struct source_edit
+{
+
+    size_type offset_;   // in the previous source
+    size_type removed_;  // number of characters removed at the offset
+    size_type inserted_; // number of characters inserted in their place
+
+};
+
+struct reparse_result
+{
+
+    parse_result parse_result_;
+    std::deque< size_type > changed_entries_ = {}; // indices of re-parsed entries in the updated program
+    size_type removed_entries_ = 0; // number of previous entries replaced by them
+
+};
+
+// Re-parses only the entries touched by the edit (together with the surrounding whitespace and comments up to the untouched neighbours).
+// Previous source (starting at _previous_first) should be still alive, the new source is [first, last).
+// Tags and ranges of untouched nodes are kept: ranges are moved to the new source, new nodes are tagged past the end of ranges,
+// ranges of the replaced nodes become empty ones at the place of the edit (ranges only grow, a full parse compacts them).
+// On error the previous result is returned as is (with the error set).
+reparse_result
+reparse(parse_result && _previous,
+        base_iterator_type const & _previous_first,
+        base_iterator_type const & first, base_iterator_type const & last,
+        source_edit const & _edit);
+
+}
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <insituc/base_types.hpp>
+
+#include <experimental/optional>
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <iterator>
+
+#include <cstdint>
+
+namespace insituc
+{
+namespace parser
+{
+
+namespace literal
+{
+
+// Exact conversion of (-1)^_negative * _mantissa * 10^_exponent (Clinger's fast path):
+// both the mantissa and the power of ten are exactly representable in F, so the single rounding of multiplication or division is the correct one.
+// Nothing is returned if it is not the case.
+std::experimental::optional< F >
+fast_path(bool const _negative, std::uint64_t const _mantissa, long const _exponent);
+
+// Correctly rounded conversion of the validated decimal literal by the C library.
+F
+slow_path(std::string const & _literal);
+
+template< typename iterator >
+bool
+skip_ci(iterator & _first, iterator const & _last, char_type const * const _word) // lower case _word
+{
+    iterator it = _first;
+    for (char_type const * c = _word; *c != '\0'; ++c, ++it) {
+        if ((it == _last) || ((*it | ('a' ^ 'A')) != *c)) {
+            return false;
+        }
+    }
+    _first = it;
+    return true;
+}
+
+inline
+bool
+is_digit(char_type const c)
+{
+    return ('0' <= c) && (c <= '9');
+}
+
+}
+
+// Real number literal with the syntax of x3::real_parser (optional sign, leading or trailing dot, optional exponent, nan and inf).
+// _first is advanced past the literal on success only.
+template< typename iterator >
+std::experimental::optional< F >
+scan_real_literal(iterator & _first, iterator const & _last)
+{
+    using literal::is_digit;
+    constexpr std::uint64_t max_mantissa_ = (std::numeric_limits< std::uint64_t >::max() - 9) / 10;
+    constexpr long max_exponent_ = 100000; // far beyond the range of any F
+    iterator it = _first;
+    bool negative_ = false;
+    if ((it != _last) && ((*it == '+') || (*it == '-'))) {
+        negative_ = (*it == '-');
+        ++it;
+    }
+    std::uint64_t mantissa_ = 0;
+    long exponent_ = 0;
+    bool truncated_ = false;
+    bool has_digits_ = false;
+    auto const accumulate_ = [&] (char_type const _digit, bool const _fractional)
+    {
+        has_digits_ = true;
+        if (mantissa_ <= max_mantissa_) {
+            mantissa_ = mantissa_ * 10 + static_cast< std::uint64_t >(_digit - '0');
+            if (_fractional) {
+                --exponent_;
+            }
+        } else {
+            truncated_ = truncated_ || (_digit != '0');
+            if (!_fractional) {
+                ++exponent_;
+            }
+        }
+    };
+    for (; (it != _last) && is_digit(*it); ++it) {
+        accumulate_(*it, false);
+    }
+    if ((it != _last) && (*it == '.')) {
+        iterator fraction_ = std::next(it);
+        if (has_digits_ || ((fraction_ != _last) && is_digit(*fraction_))) {
+            for (it = fraction_; (it != _last) && is_digit(*it); ++it) {
+                accumulate_(*it, true);
+            }
+        }
+    }
+    if (!has_digits_) {
+        F value_;
+        if (literal::skip_ci(it, _last, "nan")) {
+            if ((it != _last) && (*it == '(')) {
+                iterator payload_ = std::find(std::next(it), _last, ')');
+                if (payload_ != _last) {
+                    it = std::next(payload_);
+                }
+            }
+            value_ = std::numeric_limits< F >::quiet_NaN();
+        } else if (literal::skip_ci(it, _last, "inf")) {
+            literal::skip_ci(it, _last, "inity");
+            value_ = std::numeric_limits< F >::infinity();
+        } else {
+            return {};
+        }
+        _first = it;
+        return negative_ ? -value_ : value_;
+    }
+    if ((it != _last) && ((*it == 'e') || (*it == 'E'))) {
+        iterator exponent_first_ = std::next(it);
+        bool negative_exponent_ = false;
+        if ((exponent_first_ != _last) && ((*exponent_first_ == '+') || (*exponent_first_ == '-'))) {
+            negative_exponent_ = (*exponent_first_ == '-');
+            ++exponent_first_;
+        }
+        if ((exponent_first_ != _last) && is_digit(*exponent_first_)) { // otherwise the exponent is not a part of the literal
+            long decimal_exponent_ = 0;
+            for (it = exponent_first_; (it != _last) && is_digit(*it); ++it) {
+                if (decimal_exponent_ < max_exponent_) {
+                    decimal_exponent_ = decimal_exponent_ * 10 + (*it - '0');
+                }
+            }
+            exponent_ += (negative_exponent_ ? -decimal_exponent_ : decimal_exponent_);
+        }
+    }
+    std::experimental::optional< F > value_;
+    if (!truncated_) {
+        value_ = literal::fast_path(negative_, mantissa_, exponent_);
+    }
+    if (!value_) {
+        value_ = literal::slow_path(std::string(_first, it));
+    }
+    _first = it;
+    return value_;
+}
+
+}
+}
@@ -25,6 +25,15 @@ struct parse_result
 parse_result
 parse(base_iterator_type const & first, base_iterator_type const & last);
 
+// subrange of the enclosing input, line positions of the iterators are preserved
+parse_result
+parse(input_iterator_type const & beg, input_iterator_type const & end);
+
+// Input is split at top level entry boundaries (see find_entry_end) and the chunks are parsed concurrently by up to _concurrency threads (0 means hardware concurrency).
+// Entries are merged in definition order, ranges and tags are numbered as if the input was parsed at once.
+parse_result
+parse_parallel(base_iterator_type const & first, base_iterator_type const & last, size_type _concurrency = 0);
+
 std::experimental::optional< G >
 parse_real_number(base_iterator_type const & first, base_iterator_type const & last);
 
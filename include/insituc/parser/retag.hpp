@@ -0,0 +1,16 @@
+#pragma once
+
+#include <insituc/base_types.hpp>
+#include <insituc/ast/ast.hpp>
+
+namespace insituc
+{
+namespace parser
+{
+
+// Adds the offset to all the assigned tags of the entry. Used when ranges of separately parsed chunks are concatenated.
+void
+shift_tags(ast::entry_definition & _entry, size_type const _offset);
+
+}
+}
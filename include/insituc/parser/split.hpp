@@ -0,0 +1,103 @@
+#pragma once
+
+#include <insituc/base_types.hpp>
+#include <insituc/ast/tokens.hpp>
+
+#include <experimental/optional>
+#include <algorithm>
+#include <iterator>
+
+#include <cstring>
+#include <cctype>
+
+namespace insituc
+{
+namespace parser
+{
+
+namespace split
+{
+
+template< typename iterator >
+bool
+starts_with(iterator const & _first, iterator const & _last, char_type const * const _prefix)
+{
+    iterator it = _first;
+    for (char_type const * c = _prefix; *c != '\0'; ++c, ++it) {
+        if ((it == _last) || (*it != *c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template< typename iterator >
+iterator
+skip_past(iterator const & _first, iterator const & _last, char_type const * const _delimiter)
+{
+    char_type const * const delimiter_end_ = _delimiter + std::strlen(_delimiter);
+    iterator const found_ = std::search(_first, _last, _delimiter, delimiter_end_);
+    if (found_ == _last) {
+        return _last;
+    }
+    return std::next(found_, std::distance(_delimiter, delimiter_end_));
+}
+
+template< typename iterator >
+bool
+is_keyword(iterator const & _first, iterator const & _last, ast::keyword const _keyword)
+{
+    char_type const * const keyword_ = ast::c_str(_keyword);
+    return std::equal(_first, _last, keyword_, keyword_ + std::strlen(keyword_));
+}
+
+}
+
+// Lexical pre-scan: end of the first top level entry definition (function ... end) in the input, with respect to comments, pragmas and begin-end nesting.
+// Unterminated entry extends to the end of input. Nothing is returned if there are no tokens left.
+template< typename iterator >
+std::experimental::optional< iterator >
+find_entry_end(iterator _first, iterator const & _last)
+{
+    using split::starts_with;
+    using split::skip_past;
+    using split::is_keyword;
+    size_type depth_ = 0;
+    bool has_tokens_ = false;
+    while (_first != _last) {
+        auto const c = static_cast< unsigned char >(*_first);
+        if (std::isspace(c) != 0) {
+            ++_first;
+        } else if (starts_with(_first, _last, "//")) {
+            _first = skip_past(_first, _last, "\n");
+        } else if (starts_with(_first, _last, "/*")) {
+            _first = skip_past(std::next(_first, 2), _last, "*/");
+        } else if (starts_with(_first, _last, "[[")) {
+            _first = skip_past(std::next(_first, 2), _last, "]]");
+            has_tokens_ = true;
+        } else if ((std::isalnum(c) != 0) || (c == '_')) { // numbers are consumed whole for exponents not to be seen as words
+            iterator const word_ = _first;
+            while ((_first != _last) && ((std::isalnum(static_cast< unsigned char >(*_first)) != 0) || (*_first == '_') || (*_first == '.'))) {
+                ++_first;
+            }
+            has_tokens_ = true;
+            if (is_keyword(word_, _first, ast::keyword::function_) || is_keyword(word_, _first, ast::keyword::begin_)) {
+                ++depth_;
+            } else if (is_keyword(word_, _first, ast::keyword::end_) && (0 < depth_)) {
+                if (--depth_ == 0) {
+                    return _first;
+                }
+            }
+        } else {
+            ++_first;
+            has_tokens_ = true;
+        }
+    }
+    if (has_tokens_) {
+        return _last;
+    }
+    return {};
+}
+
+}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <insituc/parser/base_types.hpp>
+#include <insituc/ast/ast.hpp>
+
+#include <experimental/optional>
+#include <functional>
+#include <string>
+
+namespace insituc
+{
+namespace parser
+{
+
+using entry_consumer = std::function< bool (ast::entry_definition && _entry) >;
+
+// Maps the file into memory and parses it entry by entry: the source is split lexically at the boundaries of top level entry definitions
+// (comments, pragmas and begin-end blocks are respected), then the source of each entry is copied out, parsed and passed to the consumer.
+// Consumer returns false to stop. Peak memory is bounded by the largest entry instead of the whole file.
+// Returns the description of the first error (prefixed with the line number) or nothing on success.
+std::experimental::optional< std::string >
+parse_file(std::string const & _filename, entry_consumer const & _consumer);
+
+}
+}
@@ -43,6 +43,7 @@ struct translator
         assert(instance_.code_.empty());
         assert(instance_.heap_.empty());
         assert(instance_.stack_.empty());
+        assembler_ = &_assembler;
         if (!_assembler.for_each_function([&] (meta::function const & _function) -> result_type { return translate_function(_function); })) {
             return false;
         }
@@ -59,6 +60,7 @@ private :
 
     instance instance_;
     size_type stack_pointer_;
+    meta::assembler const * assembler_ = nullptr; // callees of expanded calls
 
     result_type
     translate_function(meta::function const & _function)
@@ -73,6 +75,44 @@ private :
         return true;
     }
 
+    static constexpr size_type inline_size = 8; // calls of functions of at most so many instructions are expanded in place
+
+    static
+    bool
+    is_inlined(meta::function const & _callee)
+    {
+        return _callee.options_.inline_.value_or(!(inline_size < _callee.code_.size())); // [[ inline ]] or [[ noinline ]] of the callee decides
+    }
+
+    // the callee runs on the same stack frame as if it was called: its stack pointer starts from zero and climbs by climbing_
+    result_type
+    translate_inlined(meta::function const & _callee)
+    {
+        size_type const stack_pointer_caller_ = std::exchange(stack_pointer_, 0);
+        if (!_callee.for_each_instruction(visit([&] (auto const & i) -> result_type { return translate_inlined(i); }))) {
+            return false;
+        }
+        assert(stack_pointer_ == _callee.climbing_);
+        stack_pointer_ = stack_pointer_caller_ + _callee.climbing_;
+        return true;
+    }
+
+    template< typename instruction >
+    result_type
+    translate_inlined(instruction const & _instruction)
+    {
+        return translate(_instruction);
+    }
+
+    result_type
+    translate_inlined(meta::instruction_binary const & _instruction)
+    {
+        if (_instruction.mnemocode_ == mnemocode::ret) {
+            return true; // falls through to the rest of the caller
+        }
+        return translate(_instruction);
+    }
+
     using near_type = std::int8_t;
     using far_type = std::int32_t;
 
@@ -2,11 +2,111 @@
 
 #include <insituc/ast/ast.hpp>
 
+#include <map>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <shared_mutex>
+
 namespace insituc
 {
 namespace transform
 {
 
+// Memoization of the derivatives of the _primitives: shared between calls of derive and Jacobian, it can be kept alive between requests.
+// Symbols of the entries and wrts are interned, a derivative is looked up by interned (function, wrts) sequence in logarithmic time.
+// Both _primitives and the cache should outlive the derived programs: results contain permanent references to their internals.
+// Member functions are thread-safe: concurrent derivations share the cache, a derivative derived by several threads at once is kept once.
+// Sequential derivations hold a shared derivation lock; derive_parallel and derive_columns_parallel reorder the derivatives inserted during their run,
+// so they hold an exclusive one.
+struct derivative_cache
+{
+
+    using key = std::vector< size_type >; // interned symbol of the function followed by interned wrts in the order of differentiation
+
+    struct derivative
+    {
+
+        ast::entry_definition entry_;
+        std::deque< key > callees_;
+
+    };
+
+    explicit
+    derivative_cache(ast::program const & _primitives);
+
+    derivative_cache(ast::program const && _primitives) = delete;
+
+    key
+    intern(ast::symbol const & _function, ast::symbols const & _wrts);
+
+    ast::entry_definition const *
+    find_primitive(key const & _key) const;
+
+    derivative const *
+    find_derivative(key const & _key) const;
+
+    derivative const &
+    insert(key && _key, derivative && _derivative); // if the _key is already present, the present derivative wins
+
+    void
+    reorder(size_type const _first, std::deque< key > const & _keys); // derivatives inserted after the first _first ones are released in order of their first occurrence in _keys
+
+    ast::program
+    release(); // moves all the derivatives out in order of their creation and clears the cache
+
+    std::shared_lock< std::shared_timed_mutex >
+    share_derivation()
+    {
+        return std::shared_lock< std::shared_timed_mutex >{derivation_mutex_};
+    }
+
+    std::unique_lock< std::shared_timed_mutex >
+    own_derivation()
+    {
+        return std::unique_lock< std::shared_timed_mutex >{derivation_mutex_};
+    }
+
+    ast::program const &
+    primitives() const
+    {
+        return primitives_;
+    }
+
+    size_type
+    size() const
+    {
+        std::lock_guard< std::mutex > const lock_{mutex_};
+        return derivatives_.size();
+    }
+
+private :
+
+    ast::program const & primitives_;
+    std::map< ast::symbol, size_type > symbols_;
+    std::map< key, ast::entry_definition const * > primitive_entries_;
+    std::map< key, derivative > derivatives_; // node-based: references are stable
+    std::deque< key > order_;
+    mutable std::mutex mutex_; // primitive_entries_ are not guarded: they are immutable after construction
+    std::shared_timed_mutex derivation_mutex_;
+
+};
+
+// Derived entries (including derivatives of callees and lower order derivatives) in order of dependencies, callees first.
+// Derivatives already known to the _cache are not derived again, the result does not depend on contents of the _cache.
+ast::program
+derive(derivative_cache & _cache,
+       ast::identifier _target);
+
+ast::program
+derive(derivative_cache & _cache,
+       ast::symbols _targets,
+       ast::symbols const & _wrts);
+
+ast::program
+derive(derivative_cache & _cache,
+       ast::symbols const & _wrts);
+
 ast::program
 derive(ast::program const & _primitives,
        ast::identifier _target);
@@ -34,5 +134,31 @@ void
 derive(ast::program const && _primitives,
        ast::symbols _wrts) = delete; // result should contain permanent references to the _primitives' internals
 
+// Targets are derived by up to _concurrency threads (0 means hardware concurrency) sharing the _cache.
+// Result (and order of the release of the _cache) is the same as of the sequential derive.
+ast::program
+derive_parallel(derivative_cache & _cache,
+                ast::symbols const & _targets,
+                ast::symbols const & _wrts,
+                size_type _concurrency = 0);
+
+// derive(_cache, column) for each of the _columns in order: all the (column, primitive) pairs are derived concurrently.
+ast::programs
+derive_columns_parallel(derivative_cache & _cache,
+                        std::deque< ast::symbols > const & _columns,
+                        size_type _concurrency = 0);
+
+ast::program
+derive_parallel(ast::program const & _primitives,
+                ast::symbols const & _targets,
+                ast::symbols const & _wrts,
+                size_type _concurrency = 0);
+
+void
+derive_parallel(ast::program const && _primitives,
+                ast::symbols const & _targets,
+                ast::symbols const & _wrts,
+                size_type _concurrency = 0) = delete; // result should contain permanent references to the _primitives' internals
+
 }
 }
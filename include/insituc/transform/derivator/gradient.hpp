@@ -0,0 +1,52 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+#include <deque>
+
+namespace insituc
+{
+namespace transform
+{
+
+// Reverse mode (adjoint) differentiation of a scalar entry: the result entry _name returns the value of the _entry followed by partial derivatives
+// with respect to each of _wrts (global variables or arguments). All the intermediate values are calculated once (forward sweep),
+// then adjoints are accumulated from the result back to the inputs (reverse sweep), so the cost does not depend on the number of _wrts.
+// Entry substitutions are not supported (the callee should be inlined first).
+ast::entry_definition
+gradient(ast::entry_definition const & _entry,
+         ast::symbols const & _wrts,
+         ast::symbol _name);
+
+// Hessian-vector product in forward over reverse mode: the result entry _name takes the additional arguments _direction (a component per wrt)
+// and returns the value of the _entry, its gradient with respect to _wrts and the product of the Hessian by the _direction.
+// Only the tangents of the gradient computation along the _direction are calculated, the Hessian itself is never formed.
+ast::entry_definition
+Hessian_vector_product(ast::entry_definition const & _entry,
+                       ast::symbols const & _wrts,
+                       ast::symbols const & _direction,
+                       ast::symbol _name);
+
+// Dual numbers (vector forward mode): the result entry _name takes the components of each of the k _directions (one per wrt) as additional arguments
+// and returns the values of the _function followed by the products J * v for each of the _directions. The primal is calculated once,
+// every temporary carries its value and k tangents, so a single compiled call gives both f and all the directional derivatives.
+ast::entry_definition
+dual(ast::entry_definition const & _function,
+     ast::symbols const & _wrts,
+     std::deque< ast::symbols > const & _directions,
+     ast::symbol _name);
+
+// Fused Jacobian: the result entry _name returns the values of the _function followed by the columns of partial derivatives
+// with respect to each of _wrts. Tangents of all the columns are calculated in the single entry (vector forward mode),
+// the primal and the subexpressions common to the columns are calculated once. Structurally orthogonal columns are derived together
+// in compressed form (see <insituc/transform/derivator/sparsity.hpp>), structural zeros are returned as zero constants.
+// Results beyond the _output_limit (depth of x87 stack by default) are assigned to the caller-provided global variables _spill in order.
+ast::entry_definition
+Jacobian(ast::entry_definition const & _function,
+         ast::symbols const & _wrts,
+         ast::symbol _name,
+         size_type const _output_limit = 8,
+         ast::symbols const & _spill = {});
+
+}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+#include <deque>
+#include <set>
+
+namespace insituc
+{
+namespace transform
+{
+
+using sparsity_pattern = std::deque< std::set< size_type > >; // for each value returned by an entry: positions of the wrts, on which the value structurally depends
+
+// Structural dependencies of the values returned by the entry _target on the _wrts (arguments of the entry or global variables).
+// Callees are analyzed once and their summaries are reused for all the substitutions.
+sparsity_pattern
+get_sparsity_pattern(ast::program const & _program,
+                     ast::symbol const & _target,
+                     ast::symbols const & _wrts);
+
+sparsity_pattern
+get_sparsity_pattern(ast::entry_definition const & _entry,
+                     ast::symbols const & _wrts); // entry substitutions are not allowed
+
+using column_colouring = std::deque< size_type >; // colour of each column of the Jacobian
+
+// Greedy colouring of the column intersection graph: structurally orthogonal columns (no value depends on both of them) can share a colour
+// and hence can be derived together in a single sweep. Colours are numbered from zero densely.
+column_colouring
+colour_columns(sparsity_pattern const & _sparsity_pattern,
+               size_type const _column_count);
+
+}
+}
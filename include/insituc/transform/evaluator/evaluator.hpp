@@ -20,5 +20,13 @@ evaluate(ast::program const & _program);
 ast::program
 evaluate(ast::program && _program);
 
+// Entries are evaluated independently by up to _concurrency threads (0 means hardware concurrency), the result keeps their order.
+// Nodes are allocated by the worker threads, so the result is heap-allocated regardless of the arena installed by the caller.
+ast::program
+evaluate_parallel(ast::program const & _program, size_type _concurrency = 0);
+
+ast::program
+evaluate_parallel(ast::program && _program, size_type _concurrency = 0);
+
 }
 }
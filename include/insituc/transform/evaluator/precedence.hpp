@@ -0,0 +1,22 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+namespace insituc
+{
+namespace transform
+{
+
+// Converts flat expressions (first operand and the list of operations) into binary expression trees once, without any other simplification,
+// so that subsequent passes and the compiler do not run the shunting-yard algorithm again. The result contains no ast::expression nodes.
+ast::operand
+resolve_precedence(ast::expression const & _expression);
+
+ast::entry_definition
+resolve_precedence(ast::entry_definition const & _entry);
+
+ast::program
+resolve_precedence(ast::program const & _program);
+
+}
+}
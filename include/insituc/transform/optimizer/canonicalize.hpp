@@ -0,0 +1,23 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+namespace insituc
+{
+namespace transform
+{
+
+// Intended for evaluated ASTs (i.e. expressions are already converted into binary expression trees).
+// Sums are normalized into signed monomials, products into constant coefficient and integer powers of factors (in order of the first occurrence).
+// Like terms (equal up to the order of factors) are collected, constant factors are merged, equal factors are joined into powers.
+// Only reduced sums and products are rebuilt, the others retain their shape. Sums and products of too many terms are not touched.
+// Factors of opposite exponents and like terms of opposite signs are cancelled (x / y * y -> x, x * y - y * x -> 0) only if _cancel is set:
+// it is exact for finite non-zero values only.
+ast::entry_definition
+canonicalize(ast::entry_definition const & _entry, bool const _cancel = false);
+
+ast::program
+canonicalize(ast::program const & _program, bool const _cancel = false);
+
+}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+namespace insituc
+{
+namespace transform
+{
+
+// Subexpressions occurring more then once with the same values of the variables they depend on are calculated once into hidden local variables.
+// Reuse is limited to the scope of the first occurrence and is invalidated by (re)declarations and assignments of the variables it depends on,
+// so a subexpression is hoisted only if it occurs again within that scope.
+ast::entry_definition
+eliminate_common_subexpressions(ast::entry_definition const & _entry);
+
+ast::program
+eliminate_common_subexpressions(ast::program const & _program);
+
+}
+}
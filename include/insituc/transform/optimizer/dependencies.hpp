@@ -0,0 +1,132 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+#include <insituc/ast/compare.hpp>
+#include <insituc/ast/hash.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <set>
+
+namespace insituc
+{
+namespace transform
+{
+
+// hashing and equality of the pointed operands, to key the maps by subexpressions of an AST without copying them
+struct operand_cptr_hash
+{
+
+    size_type
+    operator () (ast::operand_cptr const _operand_cptr) const
+    {
+        return ast::hash{}(*_operand_cptr);
+    }
+
+};
+
+struct operand_cptr_equal
+{
+
+    bool
+    operator () (ast::operand_cptr const _lhs, ast::operand_cptr const _rhs) const
+    {
+        return (*_lhs == *_rhs);
+    }
+
+};
+
+// collects identifiers, which value of an operand depends on
+struct dependencies
+{
+
+    std::set< ast::identifier > & identifiers_;
+
+    void
+    collect(ast::empty const & /*_empty*/) const
+    {
+
+    }
+
+    void
+    collect(G const & /*_value*/) const
+    {
+
+    }
+
+    void
+    collect(ast::constant const /*_constant*/) const
+    {
+
+    }
+
+    void
+    collect(ast::intrinsic_invocation const & _ast) const
+    {
+        operator () (_ast.argument_list_.rvalues_);
+    }
+
+    void
+    collect(ast::entry_substitution const & _ast) const
+    {
+        operator () (_ast.argument_list_.rvalues_);
+    }
+
+    void
+    collect(ast::identifier const & _identifier) const
+    {
+        identifiers_.insert(_identifier);
+    }
+
+    void
+    collect(ast::unary_expression const & _ast) const
+    {
+        operator () (_ast.operand_);
+    }
+
+    void
+    collect(ast::binary_expression const & _ast) const
+    {
+        operator () (_ast.lhs_);
+        operator () (_ast.rhs_);
+    }
+
+    void
+    collect(ast::expression const & _expression) const
+    {
+        operator () (_expression.first_);
+        for (ast::operation const & operation_ : _expression.rest_) {
+            operator () (operation_.operand_);
+        }
+    }
+
+    void
+    collect(ast::rvalue_list const & _rvalue_list) const
+    {
+        operator () (_rvalue_list.rvalues_);
+    }
+
+    void
+    collect(ast::operand_cptr const _operand_cptr) const
+    {
+        operator () (*_operand_cptr);
+    }
+
+    void
+    operator () (ast::operand const & _operand) const
+    {
+        visit([&] (auto const & o) { collect(o); }, *_operand);
+    }
+
+    void
+    operator () (ast::rvalues const & _rvalues) const
+    {
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            operator () (rvalue_);
+        }
+    }
+
+};
+
+}
+}
@@ -0,0 +1,473 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+#include <insituc/transform/optimizer/dependencies.hpp>
+#include <insituc/utility/append.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <experimental/optional>
+#include <map>
+#include <set>
+#include <deque>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <initializer_list>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace transform
+{
+
+// Traversal shared by the passes, which calculate operands once into hidden local variables of the enclosing statement list.
+// The first pass collects occurrences, the second one rewrites the entry. Results are available within the scope of the first occurrence
+// until (re)declaration or assignment of the variables they depend on, so occurrences are told apart by epoch(): the latest (re)declaration
+// or assignment of their dependencies. Both passes number statement blocks in the same order, blocks_ is the path to the current statement list.
+// The policy derives from the traversal and provides:
+//     bool count_node(ast::operand const &)                                      - records an occurrence, false stops descent into its operands;
+//     std::experimental::optional< ast::operand > substitute(ast::operand const &) - replacement of an operand, if any;
+//     static void invalidate(available &, ast::lvalues const &)                    - only if available is not a map of values with dependencies_.
+template< typename policy, typename available >
+struct hoisting
+{
+
+    std::set< string_type > names_;
+    available available_;
+    std::deque< available > scopes_; // available results of enclosing statement blocks
+    ast::statements * hoisted_ = nullptr;
+    size_type index_ = 0;
+    std::map< ast::identifier, size_type > stamps_; // time of the latest (re)declaration or assignment
+    size_type time_ = 0;
+    std::deque< size_type > blocks_; // ids of the enclosing statement blocks, 0 is the body of the entry
+    size_type block_count_ = 0;
+
+    // both passes stamp the same statements in the same order
+    void
+    stamp(ast::lvalues const & _lvalues)
+    {
+        ++time_;
+        for (ast::lvalue const & lvalue_ : _lvalues) {
+            stamps_[lvalue_] = time_;
+        }
+    }
+
+    void
+    enter_block()
+    {
+        blocks_.push_back(++block_count_);
+    }
+
+    void
+    leave_block()
+    {
+        assert(1 < blocks_.size());
+        blocks_.pop_back();
+    }
+
+    // equal operands of the same epoch have equal values
+    size_type
+    epoch(ast::operand const & _operand) const
+    {
+        std::set< ast::identifier > dependencies_;
+        dependencies{dependencies_}(_operand);
+        size_type epoch_ = 0;
+        for (ast::identifier const & dependency_ : dependencies_) {
+            auto const stamp_ = stamps_.find(dependency_);
+            if ((stamp_ != std::end(stamps_)) && (epoch_ < stamp_->second)) {
+                epoch_ = stamp_->second;
+            }
+        }
+        return epoch_;
+    }
+
+    // first pass: occurrences
+
+    void
+    count_operand(ast::empty const & /*_empty*/)
+    {
+
+    }
+
+    void
+    count_operand(G const & /*_value*/)
+    {
+
+    }
+
+    void
+    count_operand(ast::constant const /*_constant*/)
+    {
+
+    }
+
+    void
+    count_operand(ast::intrinsic_invocation const & _ast)
+    {
+        count(_ast.argument_list_.rvalues_);
+    }
+
+    void
+    count_operand(ast::entry_substitution const & _ast)
+    {
+        names_.insert(_ast.entry_name_.symbol_.name_);
+        count(_ast.argument_list_.rvalues_);
+    }
+
+    void
+    count_operand(ast::identifier const & _identifier)
+    {
+        names_.insert(_identifier.symbol_.name_);
+    }
+
+    void
+    count_operand(ast::unary_expression const & _ast)
+    {
+        count(_ast.operand_);
+    }
+
+    void
+    count_operand(ast::binary_expression const & _ast)
+    {
+        count(_ast.lhs_);
+        count(_ast.rhs_);
+    }
+
+    void
+    count_operand(ast::expression const & _expression)
+    {
+        count(_expression.first_);
+        for (ast::operation const & operation_ : _expression.rest_) {
+            count(operation_.operand_);
+        }
+    }
+
+    void
+    count_operand(ast::rvalue_list const & _rvalue_list)
+    {
+        count(_rvalue_list.rvalues_);
+    }
+
+    void
+    count_operand(ast::operand_cptr const _operand_cptr)
+    {
+        count(*_operand_cptr);
+    }
+
+    void
+    count(ast::operand const & _operand)
+    {
+        ast::operand const & operand_ = ast::unref(_operand);
+        if (!self().count_node(operand_)) {
+            return;
+        }
+        visit([&] (auto const & o) { count_operand(o); }, *operand_);
+    }
+
+    void
+    count(ast::rvalues const & _rvalues)
+    {
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            count(rvalue_);
+        }
+    }
+
+    void
+    count(ast::lvalues const & _lvalues)
+    {
+        for (ast::lvalue const & lvalue_ : _lvalues) {
+            names_.insert(lvalue_.symbol_.name_);
+        }
+    }
+
+    void
+    count_statement(ast::empty const & /*_empty*/)
+    {
+
+    }
+
+    void
+    count_statement(ast::variable_declaration const & _ast)
+    {
+        count(_ast.lhs_.lvalues_);
+        count(_ast.rhs_.rvalues_);
+        stamp(_ast.lhs_.lvalues_);
+    }
+
+    void
+    count_statement(ast::assignment const & _assignment)
+    {
+        count(_assignment.lhs_.lvalues_);
+        count(_assignment.rhs_.rvalues_);
+        stamp(_assignment.lhs_.lvalues_);
+    }
+
+    void
+    count_statement(ast::statement_block const & _statement_block)
+    {
+        enter_block();
+        count(_statement_block.statements_);
+        leave_block();
+    }
+
+    void
+    count(ast::statements const & _statements)
+    {
+        for (ast::statement const & statement_ : _statements) {
+            visit([&] (auto const & s) { count_statement(s); }, *statement_);
+        }
+    }
+
+    // second pass: hoisting
+
+    // names with common unused index, one per prefix
+    ast::lvalues
+    make_hidden(std::initializer_list< string_type > const _prefixes)
+    {
+        for (;;) {
+            string_type const index_string_ = std::to_string(index_++);
+            bool unused_ = true;
+            for (string_type const & prefix_ : _prefixes) {
+                if (names_.find(prefix_ + index_string_) != std::end(names_)) {
+                    unused_ = false;
+                    break;
+                }
+            }
+            if (unused_) {
+                ast::lvalues lvalues_;
+                for (string_type const & prefix_ : _prefixes) {
+                    ast::identifier hidden_;
+                    hidden_.symbol_.name_ = prefix_ + index_string_;
+                    lvalues_.push_back(std::move(hidden_));
+                }
+                return lvalues_;
+            }
+        }
+    }
+
+    // declares the hidden variables in front of the current statement
+    ast::rvalues
+    hoist(ast::lvalues && _lvalues, ast::operand && _operand)
+    {
+        ast::rvalues rvalues_;
+        for (ast::lvalue const & lvalue_ : _lvalues) {
+            rvalues_.push_back(lvalue_);
+        }
+        assert(hoisted_);
+        hoisted_->push_back(ast::variable_declaration{{std::move(_lvalues)}, {append< ast::rvalues >(std::move(_operand))}});
+        return rvalues_;
+    }
+
+    template< typename map >
+    static
+    void
+    invalidate(map & _map,
+               ast::lvalues const & _lvalues)
+    {
+        auto m = std::begin(_map);
+        while (m != std::end(_map)) {
+            std::set< ast::identifier > const & dependencies_ = m->second.dependencies_;
+            bool dependent_ = false;
+            for (ast::lvalue const & lvalue_ : _lvalues) {
+                if (dependencies_.find(lvalue_) != std::end(dependencies_)) {
+                    dependent_ = true;
+                    break;
+                }
+            }
+            if (dependent_) {
+                m = _map.erase(m);
+            } else {
+                ++m;
+            }
+        }
+    }
+
+    ast::operand
+    rewrite_operand(ast::empty const & _empty) const
+    {
+        return _empty;
+    }
+
+    ast::operand
+    rewrite_operand(G const & _value) const
+    {
+        return _value;
+    }
+
+    ast::operand
+    rewrite_operand(ast::constant const _constant) const
+    {
+        return _constant;
+    }
+
+    ast::operand
+    rewrite_operand(ast::intrinsic_invocation const & _ast)
+    {
+        return ast::intrinsic_invocation{_ast.intrinsic_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}};
+    }
+
+    ast::operand
+    rewrite_operand(ast::entry_substitution const & _ast)
+    {
+        return ast::entry_substitution{_ast.entry_name_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}};
+    }
+
+    ast::operand
+    rewrite_operand(ast::identifier const & _identifier) const
+    {
+        return _identifier;
+    }
+
+    ast::operand
+    rewrite_operand(ast::unary_expression const & _ast)
+    {
+        return ast::unary_expression{_ast.operator_, operator () (_ast.operand_)};
+    }
+
+    ast::operand
+    rewrite_operand(ast::binary_expression const & _ast)
+    {
+        ast::operand lhs_ = operator () (_ast.lhs_);
+        return ast::binary_expression{std::move(lhs_), _ast.operator_, operator () (_ast.rhs_)};
+    }
+
+    ast::operand
+    rewrite_operand(ast::expression const & _expression)
+    {
+        ast::operand first_ = operator () (_expression.first_);
+        ast::operation_list rest_;
+        for (ast::operation const & operation_ : _expression.rest_) {
+            rest_.push_back({operation_.operator_, operator () (operation_.operand_)});
+        }
+        return ast::expression{std::move(first_), std::move(rest_)};
+    }
+
+    ast::operand
+    rewrite_operand(ast::rvalue_list const & _rvalue_list)
+    {
+        return ast::rvalue_list{operator () (_rvalue_list.rvalues_), _rvalue_list.pragma_};
+    }
+
+    ast::operand
+    rewrite_operand(ast::operand_cptr const _operand_cptr)
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    // rewrites operands of the operand itself
+    ast::operand
+    rewrite(ast::operand const & _operand)
+    {
+        return visit([&] (auto const & o) -> ast::operand
+        {
+            return rewrite_operand(o);
+        }, *_operand);
+    }
+
+    ast::operand
+    operator () (ast::operand const & _operand)
+    {
+        ast::operand const & operand_ = ast::unref(_operand);
+        if (std::experimental::optional< ast::operand > substitution_ = self().substitute(operand_)) {
+            return std::move(*substitution_);
+        }
+        return rewrite(operand_);
+    }
+
+    ast::rvalues
+    operator () (ast::rvalues const & _rvalues)
+    {
+        ast::rvalues rvalues_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            rvalues_.push_back(operator () (rvalue_));
+        }
+        return rvalues_;
+    }
+
+    ast::statement
+    rewrite_statement(ast::empty const & _empty) const
+    {
+        return _empty;
+    }
+
+    ast::statement
+    rewrite_statement(ast::variable_declaration const & _ast)
+    {
+        ast::rvalues rhs_ = operator () (_ast.rhs_.rvalues_);
+        policy::invalidate(available_, _ast.lhs_.lvalues_); // shadowing is limited to the current scope
+        stamp(_ast.lhs_.lvalues_);
+        return ast::variable_declaration{_ast.lhs_, {std::move(rhs_), _ast.rhs_.pragma_}};
+    }
+
+    ast::statement
+    rewrite_statement(ast::assignment const & _assignment)
+    {
+        ast::rvalues rhs_ = operator () (_assignment.rhs_.rvalues_);
+        policy::invalidate(available_, _assignment.lhs_.lvalues_);
+        for (available & scope_ : scopes_) {
+            policy::invalidate(scope_, _assignment.lhs_.lvalues_);
+        }
+        stamp(_assignment.lhs_.lvalues_);
+        return ast::assignment{_assignment.lhs_, _assignment.operator_, {std::move(rhs_), _assignment.rhs_.pragma_}};
+    }
+
+    ast::statement
+    rewrite_statement(ast::statement_block const & _statement_block)
+    {
+        scopes_.push_back(available_);
+        enter_block();
+        ast::statements statements_ = operator () (_statement_block.statements_);
+        leave_block();
+        available_ = std::move(scopes_.back()); // hidden variables of the block are out of scope
+        scopes_.pop_back();
+        return ast::statement_block{std::move(statements_)};
+    }
+
+    ast::statements
+    operator () (ast::statements const & _statements)
+    {
+        ast::statements statements_;
+        ast::statements * const hoisted_outer_ = std::exchange(hoisted_, &statements_);
+        for (ast::statement const & statement_ : _statements) {
+            ast::statement rewritten_ = visit([&] (auto const & s) -> ast::statement
+            {
+                return rewrite_statement(s);
+            }, *statement_);
+            statements_.push_back(std::move(rewritten_));
+        }
+        hoisted_ = hoisted_outer_;
+        return statements_;
+    }
+
+    ast::entry_definition
+    operator () (ast::entry_definition const & _entry)
+    {
+        names_.insert(_entry.entry_name_.symbol_.name_);
+        blocks_.assign(1, 0);
+        count(_entry.argument_list_.lvalues_);
+        count(_entry.body_.statements_);
+        count(_entry.return_statement_.rvalues_);
+        stamps_.clear();
+        time_ = 0;
+        block_count_ = 0;
+        ast::statements statements_ = operator () (_entry.body_.statements_);
+        hoisted_ = &statements_;
+        ast::rvalues rvalues_ = operator () (_entry.return_statement_.rvalues_);
+        hoisted_ = nullptr;
+        return {_entry.entry_name_, _entry.argument_list_, {std::move(statements_)}, {std::move(rvalues_), _entry.return_statement_.pragma_}};
+    }
+
+private :
+
+    policy &
+    self()
+    {
+        return static_cast< policy & >(*this);
+    }
+
+};
+
+}
+}
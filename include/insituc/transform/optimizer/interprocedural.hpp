@@ -0,0 +1,20 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+namespace insituc
+{
+namespace transform
+{
+
+// Calls of entries defined earlier in the _program, whose arguments evaluate to constants (literals and exact constants), are executed
+// at compile time and replaced by their results. Callee may use local variables only: reading or assigning a global variable leaves the call as is.
+// _budget bounds the total work of the pass (executed statements and calls, sizes of computed values), calls exceeding it are left as is.
+// If _specialize is set, callees of calls with partially literal arguments are cloned (as "name#n" before the caller) with those arguments substituted.
+ast::program
+fold_calls(ast::program const & _program,
+           size_type _budget = 100000,
+           bool const _specialize = false);
+
+}
+}
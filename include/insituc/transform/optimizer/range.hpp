@@ -0,0 +1,48 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+#include <map>
+
+namespace insituc
+{
+namespace transform
+{
+
+struct interval // closed, infinite bounds denote unbounded sides
+{
+
+    G lower_;
+    G upper_;
+
+    bool
+    is_within(G const & _lower, G const & _upper) const
+    {
+        return !(lower_ < _lower) && !(_upper < upper_);
+    }
+
+};
+
+interval
+unbounded();
+
+using variable_ranges = std::map< ast::identifier, interval >;
+
+// Bounds are propagated from literals, constants, variables with known ranges and codomains of intrinsics.
+// Operand is not required to be evaluated, but unresolved expressions (precedence is not applied yet) are unbounded.
+interval
+get_range(ast::operand const & _operand,
+          variable_ranges const & _variable_ranges);
+
+// Intended for evaluated ASTs. Ranges of global variables are declared by the caller and should hold for any call.
+// Ranges of local variables are tracked through declarations and assignments, arguments are unbounded.
+// abs of the sign-definite operand is dropped (or replaced by negation), ln, log2 and lg of (1 + x) are lowered to yl2xp1 (if |x| <= 1 - sqrt(2) / 2),
+// pow2 and exp are lowered to pow2m1 (if the exponent of 2 is within [-1, 1]), which avoids general paths of compiler.
+// Lowerings to yl2xp1 and pow2m1 change rounding and are only done for fast_math level 2, none of them for level 0.
+// Assignment to a global variable with declared range is an error.
+ast::program
+lower_intrinsics(ast::program const & _program,
+                 variable_ranges const & _declared_ranges);
+
+}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+#include <map>
+
+namespace insituc
+{
+namespace transform
+{
+
+using frozen_variables = std::map< ast::identifier, G >;
+
+// Substitutes values of frozen global variables (if not shadowed by arguments or local variables) and evaluates the result.
+// Assignment to frozen global variable is an error. Generic version of the program stays valid for any values.
+ast::program
+specialize(ast::program const & _program,
+           frozen_variables const & _frozen_variables);
+
+}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+namespace insituc
+{
+namespace transform
+{
+
+// Intended for evaluated ASTs (i.e. expressions are already converted into binary expression trees).
+// Integer powers are expanded into chains of sqr and multiplications, which repeats the base: apply eliminate_common_subexpressions afterwards.
+// Entries with [[ fast_math = 0 ]] are left as is, for level 1 only exact rewritings are done (x + x, x * x, x * 2, division by a power of two):
+// expansion of powers and merging of exp and pow2 products change rounding and need level 2.
+ast::entry_definition
+reduce_strength(ast::entry_definition const & _entry);
+
+ast::program
+reduce_strength(ast::program const & _program);
+
+}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <insituc/ast/ast.hpp>
+
+namespace insituc
+{
+namespace transform
+{
+
+// sin and cos of equal arguments are calculated at once by sincos into hidden local variables (single fsincos instead of fsin and fcos),
+// tg and ctg of equal arguments share single tg (single fptan): ctg(x) = 1 / tg(x).
+// Sharing is limited to the scope of the first occurrence and is invalidated by (re)declarations and assignments of the variables it depends on.
+ast::entry_definition
+pair_trigonometric_functions(ast::entry_definition const & _entry);
+
+ast::program
+pair_trigonometric_functions(ast::program const & _program);
+
+}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <insituc/ast/ast.hpp>
+#include <insituc/transform/derivator/derivator.hpp>
 
 namespace insituc
 {
@@ -15,5 +16,40 @@ void
 Jacobian(ast::program const && _functions,
          ast::symbols _wrts) = delete; // result will contain references to the _primitives' internals
 
+ast::programs
+Jacobian(derivative_cache & _cache,
+         ast::symbols _wrts); // derivatives known to the _cache are reused, the _cache should outlive the result
+
+// Columns are derived by up to _concurrency threads (0 means hardware concurrency), the result is the same as of the sequential Jacobian.
+// A repeated wrt is derived once. Columns of distinct wrts never share derivatives, so each is derived with its own cache.
+ast::programs
+Jacobian_parallel(ast::program const & _functions,
+                  ast::symbols const & _wrts,
+                  size_type _concurrency = 0);
+
+void
+Jacobian_parallel(ast::program const && _functions,
+                  ast::symbols const & _wrts,
+                  size_type _concurrency = 0) = delete; // result will contain references to the _primitives' internals
+
+ast::programs
+Jacobian_parallel(derivative_cache & _cache,
+                  ast::symbols const & _wrts,
+                  size_type _concurrency = 0); // the _cache is shared by the columns (and by the functions of a column) and should outlive the result
+
+// Second order partial derivatives f{w_i, w_j} of all the _functions for i <= j only (mixed partials are symmetric).
+// First order derivatives are derived once and shared by all the rows. Entries are in order of dependencies, each entry appears once.
+ast::program
+Hessian(ast::program const & _functions,
+        ast::symbols const & _wrts);
+
+void
+Hessian(ast::program const && _functions,
+        ast::symbols const & _wrts) = delete; // result will contain references to the _functions' internals
+
+ast::program
+Hessian(derivative_cache & _cache,
+        ast::symbols const & _wrts); // the _cache should outlive the result
+
 }
 }
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <insituc/floating_point_type.hpp>
+
+namespace insituc
+{
+
+// true if `x * (1 / _value)` is bitwise equal to `x / _value` for any x, i.e. _value is finite power of two with finite reciprocal
+inline
+bool
+has_exact_reciprocal(G const & _value)
+{
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+    G const magnitude_ = abs(_value);
+    if (!(zero < magnitude_) || isinf(magnitude_)) {
+        return false;
+    }
+    G const exponent_ = logb(magnitude_);
+    if (!(scalbn(one, static_cast< int >(static_cast< F >(exponent_))) == magnitude_)) {
+        return false;
+    }
+    return !isinf(one / magnitude_);
+#pragma clang diagnostic pop
+}
+
+}
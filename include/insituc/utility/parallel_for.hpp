@@ -0,0 +1,45 @@
+#pragma once
+
+#include <insituc/base_types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace insituc
+{
+
+// Calls _body(i) for each i in [0, _count) on up to _concurrency threads (0 means hardware concurrency), the calling thread takes part.
+// Indices are dealt out one by one. The first exception stops the dealing and is rethrown after all the workers are joined.
+template< typename body >
+void
+parallel_for(size_type const _count, size_type _concurrency, body && _body)
+{
+    if (_concurrency == 0) {
+        _concurrency = std::max< size_type >(std::thread::hardware_concurrency(), 1);
+    }
+    std::atomic< size_type > next_{0};
+    auto const worker_ = [&]
+    {
+        try {
+            for (size_type i = next_++; i < _count; i = next_++) {
+                _body(i);
+            }
+        } catch (...) {
+            next_ = _count;
+            throw;
+        }
+    };
+    std::vector< std::future< void > > workers_; // futures of std::async join on destruction
+    for (size_type w = 1; w < std::min(_concurrency, _count); ++w) {
+        workers_.push_back(std::async(std::launch::async, worker_));
+    }
+    worker_();
+    for (std::future< void > & w : workers_) {
+        w.get();
+    }
+}
+
+}
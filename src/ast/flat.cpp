@@ -0,0 +1,402 @@
+#include <insituc/ast/flat.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace ast
+{
+namespace flat
+{
+
+namespace
+{
+
+template< typename type >
+index
+checked_index(type const _size)
+{
+    if (!(static_cast< size_type >(_size) < static_cast< size_type >(npos))) {
+        throw std::runtime_error("flat AST is too large");
+    }
+    return static_cast< index >(_size);
+}
+
+struct flattener
+{
+
+    program & program_;
+    std::map< identifier, index > interned_ = {};
+    std::map< operand const *, index > shared_ = {};
+
+    index
+    intern(identifier const & _identifier)
+    {
+        auto const interned_identifier_ = interned_.find(_identifier);
+        if (interned_identifier_ != std::end(interned_)) {
+            return interned_identifier_->second;
+        }
+        index const index_ = checked_index(program_.identifiers_.size());
+        program_.identifiers_.push_back(_identifier);
+        interned_.emplace(_identifier, index_);
+        return index_;
+    }
+
+    slice
+    append(std::vector< index > & _to, std::vector< index > const & _indices) const
+    {
+        slice const slice_{checked_index(_to.size()), checked_index(_indices.size())};
+        _to.insert(std::end(_to), std::cbegin(_indices), std::cend(_indices));
+        return slice_;
+    }
+
+    index
+    node(node_kind const _kind, std::uint8_t const _code, index const _payload, std::vector< index > const & _children = {})
+    {
+        index const index_ = checked_index(program_.kinds_.size());
+        program_.kinds_.push_back(_kind);
+        program_.codes_.push_back(_code);
+        program_.payloads_.push_back(_payload);
+        program_.arguments_.push_back(append(program_.children_, _children));
+        return index_;
+    }
+
+    void
+    attach(std::map< index, pragma > & _pragmas, index const _index, pragma const & _pragma) const
+    {
+        if (!_pragma.record_.empty()) {
+            _pragmas.emplace(_index, _pragma);
+        }
+    }
+
+    std::vector< index >
+    operator () (rvalues const & _rvalues)
+    {
+        std::vector< index > indices_;
+        indices_.reserve(_rvalues.size());
+        for (rvalue const & rvalue_ : _rvalues) {
+            indices_.push_back(operator () (rvalue_));
+        }
+        return indices_;
+    }
+
+    [[noreturn]]
+    index
+    flatten_operand(empty const & /*_empty*/)
+    {
+        throw std::runtime_error("empty operand in expression is not allowed");
+    }
+
+    index
+    flatten_operand(G const & _value)
+    {
+        index const value_ = checked_index(program_.values_.size());
+        program_.values_.push_back(_value);
+        return node(node_kind::value, 0, value_);
+    }
+
+    index
+    flatten_operand(constant const _constant)
+    {
+        return node(node_kind::constant, static_cast< std::uint8_t >(_constant), npos);
+    }
+
+    index
+    flatten_operand(intrinsic_invocation const & _ast)
+    {
+        index const index_ = node(node_kind::intrinsic, static_cast< std::uint8_t >(_ast.intrinsic_), npos, operator () (_ast.argument_list_.rvalues_));
+        attach(program_.pragmas_, index_, _ast.argument_list_.pragma_);
+        return index_;
+    }
+
+    index
+    flatten_operand(entry_substitution const & _ast)
+    {
+        std::vector< index > arguments_ = operator () (_ast.argument_list_.rvalues_);
+        index const index_ = node(node_kind::substitution, 0, intern(_ast.entry_name_), arguments_);
+        attach(program_.pragmas_, index_, _ast.argument_list_.pragma_);
+        return index_;
+    }
+
+    index
+    flatten_operand(identifier const & _identifier)
+    {
+        return node(node_kind::identifier, 0, intern(_identifier));
+    }
+
+    index
+    flatten_operand(unary_expression const & _ast)
+    {
+        return node(node_kind::unary, static_cast< std::uint8_t >(_ast.operator_), npos, {operator () (_ast.operand_)});
+    }
+
+    index
+    flatten_operand(binary_expression const & _ast)
+    {
+        index const lhs_ = operator () (_ast.lhs_);
+        index const rhs_ = operator () (_ast.rhs_);
+        return node(node_kind::binary, static_cast< std::uint8_t >(_ast.operator_), npos, {lhs_, rhs_});
+    }
+
+    [[noreturn]]
+    index
+    flatten_operand(expression const & /*_expression*/)
+    {
+        throw std::runtime_error("expression with unresolved precedence cannot be flattened");
+    }
+
+    index
+    flatten_operand(rvalue_list const & _rvalue_list)
+    {
+        index const index_ = node(node_kind::list, 0, npos, operator () (_rvalue_list.rvalues_));
+        attach(program_.pragmas_, index_, _rvalue_list.pragma_);
+        return index_;
+    }
+
+    index
+    flatten_operand(operand_cptr const _operand_cptr)
+    {
+        operand const & operand_ = unref(_operand_cptr);
+        auto const shared_operand_ = shared_.find(&operand_);
+        if (shared_operand_ != std::end(shared_)) {
+            return shared_operand_->second;
+        }
+        index const index_ = operator () (operand_);
+        shared_.emplace(&operand_, index_);
+        return index_;
+    }
+
+    index
+    operator () (operand const & _operand)
+    {
+        return visit([&] (auto const & o) -> index
+        {
+            return flatten_operand(o);
+        }, *_operand);
+    }
+
+    std::vector< index >
+    operator () (lvalues const & _lvalues)
+    {
+        std::vector< index > indices_;
+        indices_.reserve(_lvalues.size());
+        for (lvalue const & lvalue_ : _lvalues) {
+            indices_.push_back(intern(lvalue_));
+        }
+        return indices_;
+    }
+
+    index
+    statement_node(statement_kind const _kind, std::uint8_t const _code, slice const _lhs, slice const _rhs)
+    {
+        index const index_ = checked_index(program_.statement_kinds_.size());
+        program_.statement_kinds_.push_back(_kind);
+        program_.statement_codes_.push_back(_code);
+        program_.lhs_.push_back(_lhs);
+        program_.rhs_.push_back(_rhs);
+        return index_;
+    }
+
+    [[noreturn]]
+    index
+    flatten_statement(empty const & /*_empty*/)
+    {
+        throw std::runtime_error("empty statement is not allowed");
+    }
+
+    index
+    flatten_statement(variable_declaration const & _ast)
+    {
+        slice const rhs_ = append(program_.children_, operator () (_ast.rhs_.rvalues_));
+        index const index_ = statement_node(statement_kind::declaration, 0, append(program_.lvalues_, operator () (_ast.lhs_.lvalues_)), rhs_);
+        attach(program_.statement_pragmas_, index_, _ast.rhs_.pragma_);
+        return index_;
+    }
+
+    index
+    flatten_statement(assignment const & _ast)
+    {
+        slice const rhs_ = append(program_.children_, operator () (_ast.rhs_.rvalues_));
+        index const index_ = statement_node(statement_kind::assignment, static_cast< std::uint8_t >(_ast.operator_), append(program_.lvalues_, operator () (_ast.lhs_.lvalues_)), rhs_);
+        attach(program_.statement_pragmas_, index_, _ast.rhs_.pragma_);
+        return index_;
+    }
+
+    index
+    flatten_statement(statement_block const & _ast)
+    {
+        return statement_node(statement_kind::block, 0, {}, append(program_.nested_, operator () (_ast.statements_)));
+    }
+
+    std::vector< index >
+    operator () (statements const & _statements)
+    {
+        std::vector< index > indices_;
+        indices_.reserve(_statements.size());
+        for (statement const & statement_ : _statements) {
+            indices_.push_back(visit([&] (auto const & s) -> index
+            {
+                return flatten_statement(s);
+            }, *statement_));
+        }
+        return indices_;
+    }
+
+    void
+    operator () (entry_definition const & _entry)
+    {
+        index const entry_ = checked_index(program_.names_.size());
+        program_.names_.push_back(intern(_entry.entry_name_));
+        program_.parameters_.push_back(append(program_.lvalues_, operator () (_entry.argument_list_.lvalues_)));
+        program_.bodies_.push_back(append(program_.nested_, operator () (_entry.body_.statements_)));
+        program_.results_.push_back(append(program_.children_, operator () (_entry.return_statement_.rvalues_)));
+        attach(program_.result_pragmas_, entry_, _entry.return_statement_.pragma_);
+    }
+
+};
+
+struct unflattener
+{
+
+    program const & program_;
+
+    pragma
+    pragma_of(std::map< index, pragma > const & _pragmas, index const _index) const
+    {
+        auto const pragma_ = _pragmas.find(_index);
+        if (pragma_ == std::end(_pragmas)) {
+            return {};
+        }
+        return pragma_->second;
+    }
+
+    rvalues
+    rvalues_of(std::vector< index > const & _indices, slice const _slice) const
+    {
+        rvalues rvalues_;
+        for (index i = 0; i < _slice.count_; ++i) {
+            rvalues_.push_back(operator () (_indices[_slice.first_ + i]));
+        }
+        return rvalues_;
+    }
+
+    lvalues
+    lvalues_of(slice const _slice) const
+    {
+        lvalues lvalues_;
+        for (index i = 0; i < _slice.count_; ++i) {
+            lvalues_.push_back(program_.identifiers_[program_.lvalues_[_slice.first_ + i]]);
+        }
+        return lvalues_;
+    }
+
+    operand
+    operator () (index const _node) const
+    {
+        assert(_node < program_.size());
+        slice const arguments_ = program_.arguments_[_node];
+        std::uint8_t const code_ = program_.codes_[_node];
+        switch (program_.kinds_[_node]) {
+        case node_kind::value : {
+            return program_.values_[program_.payloads_[_node]];
+        }
+        case node_kind::constant : {
+            return static_cast< constant >(code_);
+        }
+        case node_kind::identifier : {
+            return program_.identifiers_[program_.payloads_[_node]];
+        }
+        case node_kind::intrinsic : {
+            return intrinsic_invocation{static_cast< intrinsic >(code_), {rvalues_of(program_.children_, arguments_), pragma_of(program_.pragmas_, _node)}};
+        }
+        case node_kind::substitution : {
+            return entry_substitution{program_.identifiers_[program_.payloads_[_node]], {rvalues_of(program_.children_, arguments_), pragma_of(program_.pragmas_, _node)}};
+        }
+        case node_kind::unary : {
+            assert(arguments_.count_ == 1);
+            return unary_expression{static_cast< unary >(code_), operator () (program_.children_[arguments_.first_])};
+        }
+        case node_kind::binary : {
+            assert(arguments_.count_ == 2);
+            return binary_expression{operator () (program_.children_[arguments_.first_]), static_cast< binary >(code_), operator () (program_.children_[arguments_.first_ + 1])};
+        }
+        case node_kind::list : {
+            return rvalue_list{rvalues_of(program_.children_, arguments_), pragma_of(program_.pragmas_, _node)};
+        }
+        }
+        throw std::runtime_error("unknown node kind");
+    }
+
+    statements
+    statements_of(slice const _slice) const
+    {
+        statements statements_;
+        for (index i = 0; i < _slice.count_; ++i) {
+            statements_.push_back(statement_of(program_.nested_[_slice.first_ + i]));
+        }
+        return statements_;
+    }
+
+    statement
+    statement_of(index const _statement) const
+    {
+        slice const lhs_ = program_.lhs_[_statement];
+        slice const rhs_ = program_.rhs_[_statement];
+        switch (program_.statement_kinds_[_statement]) {
+        case statement_kind::declaration : {
+            return variable_declaration{{lvalues_of(lhs_)}, {rvalues_of(program_.children_, rhs_), pragma_of(program_.statement_pragmas_, _statement)}};
+        }
+        case statement_kind::assignment : {
+            return assignment{{lvalues_of(lhs_)}, static_cast< assign >(program_.statement_codes_[_statement]), {rvalues_of(program_.children_, rhs_), pragma_of(program_.statement_pragmas_, _statement)}};
+        }
+        case statement_kind::block : {
+            return statement_block{statements_of(rhs_)};
+        }
+        }
+        throw std::runtime_error("unknown statement kind");
+    }
+
+    entry_definition
+    entry_of(index const _entry) const
+    {
+        return {program_.identifiers_[program_.names_[_entry]],
+                {lvalues_of(program_.parameters_[_entry])},
+                {statements_of(program_.bodies_[_entry])},
+                {rvalues_of(program_.children_, program_.results_[_entry]), pragma_of(program_.result_pragmas_, _entry)}};
+    }
+
+};
+
+}
+
+program
+flatten(ast::program const & _program)
+{
+    program program_;
+    flattener flattener_{program_};
+    for (entry_definition const & entry_ : _program.entries_) {
+        flattener_(entry_);
+    }
+    return program_;
+}
+
+ast::program
+unflatten(program const & _program)
+{
+    ast::program program_;
+    unflattener const unflattener_{_program};
+    for (index entry_ = 0; entry_ < checked_index(_program.names_.size()); ++entry_) {
+        program_.append(unflattener_.entry_of(entry_));
+    }
+    return program_;
+}
+
+}
+}
+}
@@ -0,0 +1,83 @@
+#include <insituc/memory/arena.hpp>
+
+#include <new>
+#include <algorithm>
+#include <utility>
+
+#include <cassert>
+
+namespace insituc
+{
+
+namespace
+{
+
+thread_local arena * current_arena = nullptr;
+
+constexpr std::size_t node_header_size = alignof(std::max_align_t); // keeps nodes maximally aligned
+static_assert(sizeof(arena *) <= node_header_size);
+
+}
+
+arena::arena(size_type const _chunk_size)
+    : chunk_size_(_chunk_size)
+{ ; }
+
+void *
+arena::allocate(size_type const _size,
+                size_type const _alignment)
+{
+    void * top_pointer_ = top_;
+    std::size_t available_bytes_ = available_;
+    if (!std::align(_alignment, _size, top_pointer_, available_bytes_)) {
+        size_type const chunk_size_bytes_ = std::max(chunk_size_, _size + _alignment); // oversized requests get their own chunk
+        chunks_.emplace_back(new unsigned char [chunk_size_bytes_]);
+        top_pointer_ = chunks_.back().get();
+        available_bytes_ = chunk_size_bytes_;
+        if (!std::align(_alignment, _size, top_pointer_, available_bytes_)) {
+            throw std::bad_alloc{};
+        }
+    }
+    top_ = static_cast< unsigned char * >(top_pointer_) + _size;
+    available_ = available_bytes_ - _size;
+    size_ += _size;
+    return top_pointer_;
+}
+
+arena::scope::scope(arena & _arena) noexcept
+    : previous_(std::exchange(current_arena, &_arena))
+{ ; }
+
+arena::scope::~scope() noexcept
+{
+    current_arena = previous_;
+}
+
+arena *
+arena::current() noexcept
+{
+    return current_arena;
+}
+
+void *
+arena::allocate_node(std::size_t const _size)
+{
+    arena * const owner_ = current_arena;
+    void * const storage_ = (owner_ ? owner_->allocate(node_header_size + _size) : ::operator new(node_header_size + _size));
+    ::new (storage_) arena *(owner_);
+    return static_cast< unsigned char * >(storage_) + node_header_size;
+}
+
+void
+arena::deallocate_node(void * const _pointer) noexcept
+{
+    if (!_pointer) {
+        return;
+    }
+    void * const storage_ = static_cast< unsigned char * >(_pointer) - node_header_size;
+    if (!*static_cast< arena ** >(storage_)) { // arena storage is released in bulk
+        ::operator delete(storage_);
+    }
+}
+
+}
@@ -4,6 +4,8 @@
 #include <insituc/utility/numeric/safe_convert.hpp>
 #include <insituc/parser/parser.hpp>
 
+#include <utility>
+
 #include <cassert>
 
 namespace insituc
@@ -11,25 +13,47 @@ namespace insituc
 namespace meta
 {
 
+namespace
+{
+
+symbol_set_type
+make_reserved_symbols()
+{
+    symbol_set_type reserved_symbols_;
+    auto const add_ = [&] (std::deque< string_type > && _reserved_symbols)
+    {
+        for (string_type & reserved_symbol_name_ : _reserved_symbols) {
+            symbol_type reserved_symbol_;
+            reserved_symbol_.symbol_.name_ = std::move(reserved_symbol_name_);
+            assert(reserved_symbol_.symbol_.name_ != "_");
+            if (!reserved_symbols_.insert(std::move(reserved_symbol_)).second) {
+                assert(false);
+            }
+        }
+    };
+    add_(parser::get_constants());
+    add_(parser::get_intrinsics());
+    add_(parser::get_keywords());
+    return reserved_symbols_;
+}
+
+symbol_set_type const &
+get_reserved_symbols()
+{
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+    static symbol_set_type const reserved_symbols_ = make_reserved_symbols(); // built once, not for every assembler
+#pragma clang diagnostic pop
+    return reserved_symbols_;
+}
+
+}
+
 assembler::assembler()
-    : monitor_(*this)
+    : reserved_symbols_(get_reserved_symbols())
+    , monitor_(*this)
 {
     dummy_placeholder_.symbol_.name_ = "_";
-    for (string_type & reserved_sybmol_ : parser::get_constants()) {
-        if (!add_reserved_symbol(std::move(reserved_sybmol_))) {
-            assert(false);
-        }
-    }
-    for (string_type & reserved_sybmol_ : parser::get_intrinsics()) {
-        if (!add_reserved_symbol(std::move(reserved_sybmol_))) {
-            assert(false);
-        }
-    }
-    for (string_type & reserved_sybmol_ : parser::get_keywords()) {
-        if (!add_reserved_symbol(std::move(reserved_sybmol_))) {
-            assert(false);
-        }
-    }
 }
 
 bool
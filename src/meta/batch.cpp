@@ -0,0 +1,164 @@
+#include <insituc/meta/batch.hpp>
+#include <insituc/meta/compiler.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <string>
+#include <utility>
+
+namespace insituc
+{
+namespace meta
+{
+
+namespace
+{
+
+struct entry_renamer
+{
+
+    std::map< ast::identifier, ast::identifier > const & names_;
+
+    void
+    rename(ast::identifier & _identifier) const
+    {
+        auto const name_ = names_.find(_identifier);
+        if (name_ != std::end(names_)) {
+            _identifier = name_->second;
+        }
+    }
+
+    template< typename type >
+    void
+    rename(type & /*_leaf*/) const
+    { ; }
+
+    void
+    rename(ast::rvalue_list & _rvalue_list) const
+    {
+        for (ast::rvalue & rvalue_ : _rvalue_list.rvalues_) {
+            operator () (rvalue_);
+        }
+    }
+
+    void
+    rename(ast::intrinsic_invocation & _ast) const
+    {
+        rename(_ast.argument_list_);
+    }
+
+    void
+    rename(ast::entry_substitution & _ast) const
+    {
+        rename(_ast.entry_name_);
+        rename(_ast.argument_list_);
+    }
+
+    void
+    rename(ast::unary_expression & _ast) const
+    {
+        operator () (_ast.operand_);
+    }
+
+    void
+    rename(ast::binary_expression & _ast) const
+    {
+        operator () (_ast.lhs_);
+        operator () (_ast.rhs_);
+    }
+
+    void
+    rename(ast::expression & _expression) const
+    {
+        operator () (_expression.first_);
+        for (ast::operation & operation_ : _expression.rest_) {
+            operator () (operation_.operand_);
+        }
+    }
+
+    void
+    operator () (ast::operand & _operand) const
+    {
+        if (_operand.active< ast::operand_cptr >()) {
+            _operand = ast::operand(ast::unref(_operand)); // shared referents are not ours to modify
+        }
+        visit([&] (auto & o) { rename_operand(o); }, *_operand);
+    }
+
+    template< typename type >
+    void
+    rename_operand(type & _ast) const
+    {
+        rename(_ast);
+    }
+
+    void
+    rename_operand(ast::identifier & /*_identifier*/) const
+    { ; } // variables
+
+    void
+    rename(ast::variable_declaration & _ast) const
+    {
+        rename(_ast.rhs_);
+    }
+
+    void
+    rename(ast::assignment & _ast) const
+    {
+        rename(_ast.rhs_);
+    }
+
+    void
+    rename(ast::statement_block & _ast) const
+    {
+        for (ast::statement & statement_ : _ast.statements_) {
+            visit([&] (auto & s) { rename(s); }, *statement_);
+        }
+    }
+
+    void
+    operator () (ast::entry_definition & _entry) const
+    {
+        rename(_entry.entry_name_);
+        rename(_entry.body_);
+        rename(_entry.return_statement_);
+    }
+
+};
+
+}
+
+bool
+compile_batch(assembler & _assembler,
+              ast::programs const & _programs,
+              entry_tables & _entry_tables)
+{
+    compiler const compiler_(_assembler);
+    size_type index_ = _entry_tables.size(); // continues numbering of earlier batches, whose names are taken
+    for (ast::program const & program_ : _programs) {
+        std::map< ast::identifier, ast::identifier > names_;
+        for (ast::entry_definition const & entry_ : program_.entries_) {
+            ast::identifier name_ = entry_.entry_name_;
+            name_.symbol_.name_ += '#' + std::to_string(index_);
+            names_.emplace(entry_.entry_name_, std::move(name_));
+        }
+        ast::program namespaced_ = program_;
+        entry_renamer const entry_renamer_{names_};
+        for (ast::entry_definition & entry_ : namespaced_.entries_) {
+            entry_renamer_(entry_);
+        }
+        if (!compiler_(namespaced_)) {
+            return false;
+        }
+        entry_table entry_table_;
+        for (auto const & name_ : names_) {
+            entry_table_.emplace(name_.first, _assembler.get_export_table().at(name_.second));
+        }
+        _entry_tables.push_back(std::move(entry_table_));
+        ++index_;
+    }
+    return true;
+}
+
+}
+}
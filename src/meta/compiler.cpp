@@ -1,6 +1,6 @@
 #include <insituc/meta/compiler.hpp>
+#include <insituc/transform/evaluator/precedence.hpp>
 
-#include <insituc/parser/pragma_parser.hpp>
 #include <insituc/utility/reverse.hpp>
 #include <insituc/utility/head.hpp>
 #include <insituc/utility/tail.hpp>
@@ -12,6 +12,8 @@
 #include <iterator>
 #include <functional>
 
+#include <cassert>
+
 namespace insituc
 {
 namespace meta
@@ -140,64 +142,6 @@ compiler::compile(ast::binary_expression const & _binary_expression) const
                         _binary_expression.rhs_);
 }
 
-auto
-compiler::tree_switch::operator () (node_type const & _lhs,
-                                    ast::binary const _operator,
-                                    node_type const & _rhs) const
--> result_type
-{
-    switch (_operator) {
-    case ast::binary::add : {
-        return operation_commutator_(_lhs, add_, _rhs);
-    }
-    case ast::binary::sub : {
-        return operation_commutator_(_lhs, sub_, _rhs);
-    }
-    case ast::binary::mul : {
-        return operation_commutator_(_lhs, mul_, _rhs);
-    }
-    case ast::binary::div : {
-        return operation_commutator_(_lhs, div_, _rhs);
-    }
-    case ast::binary::mod : {
-        if (!rpn_(_rhs)) {
-            return false;
-        }
-        if (!rpn_(_lhs)) {
-            return false;
-        }
-        return assembler_(mnemocode::fprem,
-                          mnemocode::fstp, st(1));
-    }
-    case ast::binary::pow : {
-        if (!assembler_(mnemocode::fldln2)) {
-            return false;
-        }
-        if (!rpn_(_lhs)) {
-            return false;
-        }
-        if (!assembler_(mnemocode::fyl2x)) {
-            return false;
-        }
-        if (!operation_commutator_(mul_, _rhs)) {
-            return false;
-        }
-        return assembler_(mnemocode::fldl2e,
-                          mnemocode::fmul,
-                          mnemocode::fld, st,
-                          mnemocode::frndint,
-                          mnemocode::fxch,
-                          mnemocode::fsub, st, st(1),
-                          mnemocode::f2xm1,
-                          mnemocode::fld1,
-                          mnemocode::fadd,
-                          mnemocode::fscale,
-                          mnemocode::fstp, st(1)); // pwr(l, r)
-    }
-    }
-    return false;
-}
-
 auto
 compiler::call_intrinsic(ast::intrinsic const _intrinsic,
                          ast::rvalues const & _arguments) const
@@ -206,6 +150,7 @@ compiler::call_intrinsic(ast::intrinsic const _intrinsic,
     switch (_intrinsic) {
     case ast::intrinsic::chs       : return compile_chs      (_arguments);
     case ast::intrinsic::abs       : return compile_abs      (_arguments);
+    case ast::intrinsic::sign      : return compile_sign     (_arguments);
     case ast::intrinsic::twice     : return compile_twice    (_arguments);
     case ast::intrinsic::sumsqr    : return compile_sumsqr   (_arguments);
     case ast::intrinsic::sqrt      : return compile_sqrt     (_arguments);
@@ -239,6 +184,8 @@ compiler::call_intrinsic(ast::intrinsic const _intrinsic,
     case ast::intrinsic::arccos    : return compile_arccos   (_arguments);
     case ast::intrinsic::max       : return compile_max      (_arguments);
     case ast::intrinsic::min       : return compile_min      (_arguments);
+    case ast::intrinsic::pickmax   : return compile_pick     (_arguments, true);
+    case ast::intrinsic::pickmin   : return compile_pick     (_arguments, false);
     }
     return false;
 }
@@ -486,6 +433,7 @@ compiler::compile(ast::entry_definition const & _ast) const
     if (!assembler_.enter(_ast.entry_name_, 0, std::move(arguments_))) {
         return false;
     }
+    assembler_.set_options(_ast.return_statement_.pragma_.options_);
     if (!assembler_(mnemocode::bra)) {
         return false;
     }
@@ -495,7 +443,7 @@ compiler::compile(ast::entry_definition const & _ast) const
     if (!compile(_ast.return_statement_)) {
         return false;
     }
-    if (!assembler_(mnemocode::ret, assembler_.excess(), parser::parse_pragma(_ast.return_statement_.pragma_, "drop"))) {
+    if (!assembler_(mnemocode::ret, assembler_.excess(), _ast.return_statement_.pragma_.options_.drop_)) {
         return false;
     }
     if (!assembler_(mnemocode::ket)) {
@@ -512,7 +460,8 @@ compiler::compile(ast::program const & _program) const
     if (_program.entries_.empty()) {
         return false;
     }
-    for (ast::entry_definition const & entry_ : _program.entries_) {
+    ast::program const resolved_ = transform::resolve_precedence(_program); // binary expression trees, once for all the entries
+    for (ast::entry_definition const & entry_ : resolved_.entries_) {
         if (!compile(entry_)) {
             return false;
         }
@@ -555,6 +504,27 @@ compiler::compile_abs(ast::rvalues const & _arguments) const
     return assembler_(mnemocode::fabs);
 }
 
+auto
+compiler::compile_sign(ast::rvalues const & _arguments) const
+-> result_type
+{ // branchless: the result is selected by the flags of the comparison with zero
+    if (!push(_arguments)) {
+        return false;
+    }
+    return assembler_(mnemocode::fldz,
+                      mnemocode::fucomip, st, st(1), // CF: 0 < x, ZF: 0 == x
+                      mnemocode::fld1,
+                      mnemocode::fchs,
+                      mnemocode::fld1,
+                      mnemocode::fldz,
+                      mnemocode::fcmovb, st, st(1),
+                      mnemocode::fcmovnbe, st, st(2),
+                      mnemocode::fcmovu, st, st(3), // NaN for NaN, as the evaluator folds it
+                      mnemocode::fstp, st(1),
+                      mnemocode::fstp, st(1),
+                      mnemocode::fstp, st(1));
+}
+
 auto
 compiler::compile_twice(ast::rvalues const & _arguments) const
 -> result_type
@@ -569,21 +539,10 @@ auto
 compiler::compile_sumsqr(ast::rvalues const & _arguments) const
 -> result_type
 {
-    if (_arguments.empty()) {
-        return false;
-    }
-    if (!compile_sumsqr(_arguments.front())) {
-        return false;
-    }
-    for (ast::rvalue const & argument_ : tail(_arguments)) {
-        if (!compile_sumsqr(argument_)) {
-            return false;
-        }
-        if (!assembler_(mnemocode::fadd)) {
-            return false;
-        }
-    }
-    return true;
+    return reduce_pairwise(std::cbegin(_arguments), std::cend(_arguments),
+                           [&] (ast::rvalue const & _argument) { return compile_sumsqr(_argument); },
+                           [&] { return assembler_(mnemocode::fadd); },
+                           (reassociates() ? reduction_width : 1)); // sequential sum for strict fast_math levels
 }
 
 auto
@@ -744,6 +703,9 @@ compiler::compile_poly(ast::rvalues const & _arguments) const
         }
         return true;
     }
+    if (reassociates() && (estrin_degree_ < arity_ - 2)) {
+        return compile_poly_estrin(_arguments);
+    }
     // Horner's method
     if (!push(_arguments.front())) { // (x)...
         return false;
@@ -770,6 +732,69 @@ compiler::compile_poly(ast::rvalues const & _arguments) const
     return true; // (a0 * x^0 + a1 * x^1 + a2 * x^2 + ... + ai * x^i + ... + an * x^n)
 }
 
+auto
+compiler::compile_poly_estrin(ast::rvalues const & _arguments) const
+-> result_type
+{
+    // First level of Estrin's scheme: p(x) = E(x^2) + x * O(x^2), where E and O are polynomials of even and odd coefficients.
+    // Both are evaluated by Horner's method in two interleaved independent chains.
+    // Further levels are not used: they require log2(n) powers and log2(n) partial results to be kept on the x87 stack at once.
+    size_type const arity_ = _arguments.size();
+    assert(2 < arity_);
+    auto const coefficient_ = [&] (size_type const _power) -> ast::rvalue const & { return _arguments.at(_power + 1); };
+    auto const horner_step_ = [&] (size_type const _power) -> result_type
+    {
+        if (!assembler_(mnemocode::fmul, st, st(2))) { // (chain*y) chain y x
+            return false;
+        }
+        if (auto const * const constant_ = get< ast::constant >(&coefficient_(_power))) {
+            if (*constant_ == ast::constant::zero) {
+                return true;
+            }
+        }
+        return add_(coefficient_(_power)); // (chain*y + a(i)) chain y x
+    };
+    size_type const degree_ = arity_ - 2;
+    size_type even_ = degree_ - (degree_ % 2);
+    size_type odd_ = degree_ - 1 + (degree_ % 2);
+    if (!push(_arguments.front())) { // (x)
+        return false;
+    }
+    if (!assembler_(mnemocode::fld, st,
+                    mnemocode::fmul, st, st(0))) { // (y = x^2) x
+        return false;
+    }
+    if (!push(coefficient_(even_))) { // (E) y x
+        return false;
+    }
+    if (!push(coefficient_(odd_))) { // (O) E y x
+        return false;
+    }
+    while (0 < even_) {
+        if (1 < odd_) {
+            odd_ -= 2;
+            if (!horner_step_(odd_)) { // (O) E y x
+                return false;
+            }
+        }
+        even_ -= 2;
+        if (!assembler_(mnemocode::fxch)) { // (E) O y x
+            return false;
+        }
+        if (!horner_step_(even_)) {
+            return false;
+        }
+        if (!assembler_(mnemocode::fxch)) { // (O) E y x
+            return false;
+        }
+    }
+    assert(odd_ == 1);
+    return assembler_(mnemocode::fmul, st, st(3), // (O*x) E y x
+                      mnemocode::fadd,            // (E + O*x) y x
+                      mnemocode::fstp, st(1),
+                      mnemocode::fstp, st(1));    // (result)
+}
+
 auto
 compiler::compile_frac(ast::rvalues const & _arguments) const
 -> result_type
@@ -1092,23 +1117,14 @@ auto
 compiler::compile_max(ast::rvalues const & _arguments) const
 -> result_type
 {
-    if (_arguments.empty()) {
-        return false;
-    }
-    if (!compile_max(_arguments.front())) {
-        return false;
-    }
-    for (ast::rvalue const & argument_ : tail(_arguments)) {
-        if (!compile_max(argument_)) {
-            return false;
-        }
-        if (!assembler_(mnemocode::fucomi, st, st(1),
-                        mnemocode::fcmovb, st, st(1),
-                        mnemocode::fstp, st(1))) {
-            return false;
-        }
-    }
-    return true;
+    return reduce_pairwise(std::cbegin(_arguments), std::cend(_arguments),
+                           [&] (ast::rvalue const & _argument) { return compile_max(_argument); },
+                           [&]
+    {
+        return assembler_(mnemocode::fucomi, st, st(1),
+                          mnemocode::fcmovb, st, st(1),
+                          mnemocode::fstp, st(1));
+    });
 }
 
 auto
@@ -1138,23 +1154,14 @@ auto
 compiler::compile_min(ast::rvalues const & _arguments) const
 -> result_type
 {
-    if (_arguments.empty()) {
-        return false;
-    }
-    if (!compile_min(_arguments.front())) {
-        return false;
-    }
-    for (ast::rvalue const & argument_ : tail(_arguments)) {
-        if (!compile_min(argument_)) {
-            return false;
-        }
-        if (!assembler_(mnemocode::fucomi, st, st(1),
-                        mnemocode::fcmovnbe, st, st(1),
-                        mnemocode::fstp, st(1))) {
-            return false;
-        }
-    }
-    return true;
+    return reduce_pairwise(std::cbegin(_arguments), std::cend(_arguments),
+                           [&] (ast::rvalue const & _argument) { return compile_min(_argument); },
+                           [&]
+    {
+        return assembler_(mnemocode::fucomi, st, st(1),
+                          mnemocode::fcmovnbe, st, st(1),
+                          mnemocode::fstp, st(1));
+    });
 }
 
 auto
@@ -1180,6 +1187,52 @@ compiler::compile_min(ast::rvalue const & _argument) const
     return true;
 }
 
+auto
+compiler::compile_pick(ast::rvalues const & _arguments, bool const _greatest) const
+-> result_type
+{ // the running extremum a and the picked b are kept in st(1) and st(0), fcmovbe restores them unless the next pair wins
+  // the pair wins only if ordered strictly before a (a_i > a, or a > a_i for the least), so NaN a_i never wins, as in the evaluator
+    size_type const size_ = _arguments.size();
+    if ((size_ == 0) || ((size_ % 2) != 0)) {
+        return false;
+    }
+    if (!push(_arguments[0])) {
+        return false;
+    }
+    if (!push(_arguments[1])) {
+        return false;
+    }
+    for (size_type i = 2; i < size_; i += 2) {
+        if (!push(_arguments[i])) {
+            return false;
+        }
+        if (!push(_arguments[i + 1])) {
+            return false;
+        }
+        if (_greatest) {
+            if (!assembler_(mnemocode::fxch, // a_i b_i b a
+                            mnemocode::fucomi, st, st(3))) { // CF or ZF unless a_i > a
+                return false;
+            }
+        } else {
+            if (!assembler_(mnemocode::fxch, st(3), // a a_i b b_i
+                            mnemocode::fucomi, st, st(1), // CF or ZF unless a > a_i
+                            mnemocode::fxch, st(3), // b_i a_i b a
+                            mnemocode::fxch)) { // a_i b_i b a
+                return false;
+            }
+        }
+        if (!assembler_(mnemocode::fcmovbe, st, st(3),
+                        mnemocode::fxch, // b_i a' b a
+                        mnemocode::fcmovbe, st, st(2),
+                        mnemocode::fstp, st(2), // a' b' a
+                        mnemocode::fstp, st(2))) { // b' a'
+            return false;
+        }
+    }
+    return assembler_(mnemocode::fstp, st(1));
+}
+
 #if 0
 // tanh
 // (exp(2 * x) - 1) / (exp(2 * x) + 1)
@@ -0,0 +1,128 @@
+#include <insituc/parser/incremental.hpp>
+
+#include <insituc/parser/split.hpp>
+#include <insituc/parser/retag.hpp>
+
+#include <algorithm>
+#include <vector>
+#include <iterator>
+#include <utility>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace parser
+{
+
+reparse_result
+reparse(parse_result && _previous,
+        base_iterator_type const & _previous_first,
+        base_iterator_type const & first, base_iterator_type const & last,
+        source_edit const & _edit)
+{
+    reparse_result reparse_result_{std::move(_previous)};
+    parse_result & parse_result_ = reparse_result_.parse_result_;
+    parse_result_.error_ = nullptr;
+    ranges & ranges_ = parse_result_.ranges_;
+    ast::entries & entries_ = parse_result_.ast_.entries_;
+    auto const previous_offset_ = [&] (input_iterator_type const & _position) -> size_type
+    {
+        return static_cast< size_type >(std::distance(_previous_first, _position.base()));
+    };
+    size_type const size_ = static_cast< size_type >(std::distance(first, last));
+    assert(_edit.inserted_ <= size_);
+    size_type const previous_size_ = size_ - _edit.inserted_ + _edit.removed_;
+    size_type const edit_end_ = _edit.offset_ + _edit.removed_;
+    assert(edit_end_ <= previous_size_);
+    // entries touching the edit (in the previous offsets) are replaced by whatever lies between untouched neighbours
+    size_type region_begin_ = 0;
+    size_type region_end_ = previous_size_;
+    auto affected_first_ = std::begin(entries_);
+    auto affected_last_ = std::end(entries_);
+    for (auto entry_ = std::begin(entries_); entry_ != std::end(entries_); ++entry_) {
+        range const & entry_range_ = ranges_.at(entry_->tag_);
+        if (previous_offset_(entry_range_.second) < _edit.offset_) {
+            region_begin_ = previous_offset_(entry_range_.second);
+            affected_first_ = std::next(entry_);
+        } else if (edit_end_ < previous_offset_(entry_range_.first)) {
+            region_end_ = previous_offset_(entry_range_.first);
+            affected_last_ = entry_;
+            break;
+        }
+    }
+    auto const new_offset_ = [&] (size_type const _offset) -> size_type
+    {
+        if (_offset < region_end_) {
+            return _offset;
+        }
+        return _offset - _edit.removed_ + _edit.inserted_;
+    };
+    input_iterator_type region_first_(first);
+    std::advance(region_first_, region_begin_);
+    input_iterator_type region_last_ = region_first_;
+    std::advance(region_last_, new_offset_(region_end_) - region_begin_);
+    parse_result region_result_;
+    if (find_entry_end(region_first_.base(), region_last_.base())) {
+        region_result_ = parse(region_first_, region_last_);
+        if (!!region_result_.error_) {
+            auto & error_description_ = *region_result_.error_;
+            error_description_.first_ = input_iterator_type(first);
+            error_description_.last_ = input_iterator_type(last);
+            parse_result_.error_ = std::move(region_result_.error_);
+            return reparse_result_;
+        }
+        assert(!region_result_.ranges_.empty());
+        region_result_.ranges_.pop_back(); // program node of the region
+    }
+    // ranges of untouched nodes are moved to the new source by a single sweep, to recount line positions
+    std::vector< std::pair< size_type, input_iterator_type * > > positions_;
+    for (size_type tag_ = 0; tag_ < ranges_.size(); ++tag_) {
+        if (tag_ == parse_result_.ast_.tag_) {
+            continue;
+        }
+        range & range_ = ranges_[tag_];
+        size_type const range_first_ = previous_offset_(range_.first);
+        size_type const range_last_ = previous_offset_(range_.second);
+        if (((region_begin_ < range_last_) && (range_first_ < region_end_)) || ((region_begin_ < range_first_) && (range_first_ < region_end_))) {
+            range_ = {region_first_, region_first_}; // stale
+        } else {
+            positions_.emplace_back(new_offset_(range_first_), &range_.first);
+            positions_.emplace_back(new_offset_(range_last_), &range_.second);
+        }
+    }
+    std::sort(std::begin(positions_), std::end(positions_), [] (auto const & l, auto const & r) { return l.first < r.first; });
+    {
+        input_iterator_type position_(first);
+        size_type offset_ = 0;
+        for (auto const & p : positions_) {
+            std::advance(position_, p.first - offset_);
+            offset_ = p.first;
+            *p.second = position_;
+        }
+    }
+    // re-parsed entries are tagged past the end of ranges
+    size_type const index_ = static_cast< size_type >(std::distance(std::begin(entries_), affected_first_));
+    reparse_result_.removed_entries_ = static_cast< size_type >(std::distance(affected_first_, affected_last_));
+    ast::entries & reparsed_ = region_result_.ast_.entries_;
+    for (ast::entry_definition & entry_ : reparsed_) {
+        shift_tags(entry_, ranges_.size());
+    }
+    std::move(std::begin(region_result_.ranges_), std::end(region_result_.ranges_), std::back_inserter(ranges_));
+    for (size_type i = 0; i < reparsed_.size(); ++i) {
+        reparse_result_.changed_entries_.push_back(index_ + i);
+    }
+    entries_.erase(affected_first_, affected_last_);
+    entries_.splice(affected_last_, std::move(reparsed_));
+    if (parse_result_.ast_.tag_ < ranges_.size()) {
+        if (entries_.empty()) {
+            ranges_[parse_result_.ast_.tag_] = {input_iterator_type(first), input_iterator_type(first)};
+        } else {
+            ranges_[parse_result_.ast_.tag_] = {ranges_.at(entries_.front().tag_).first, ranges_.at(entries_.back().tag_).second};
+        }
+    }
+    return reparse_result_;
+}
+
+}
+}
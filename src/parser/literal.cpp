@@ -0,0 +1,100 @@
+#include <insituc/parser/literal.hpp>
+
+#include <array>
+
+#include <cstdlib>
+
+namespace insituc
+{
+namespace parser
+{
+namespace literal
+{
+
+namespace
+{
+
+constexpr int mantissa_digits_ = std::numeric_limits< F >::digits;
+
+constexpr
+long
+max_exact_power_of_ten() // 10^k = 2^k * 5^k is exact while 5^k fits into the mantissa
+{
+    long k = 0;
+    std::uint64_t power_of_five_ = 1;
+    while ((power_of_five_ <= std::numeric_limits< std::uint64_t >::max() / 5) && ((64 <= mantissa_digits_) || (((power_of_five_ * 5) >> mantissa_digits_) == 0))) {
+        power_of_five_ *= 5;
+        ++k;
+    }
+    return k;
+}
+
+constexpr long max_exact_power_ = max_exact_power_of_ten();
+
+constexpr std::uint64_t max_exact_mantissa_ = (mantissa_digits_ < 64) ? (std::uint64_t(1) << mantissa_digits_) : std::numeric_limits< std::uint64_t >::max();
+
+constexpr
+std::array< F, max_exact_power_ + 1 >
+make_powers_of_ten()
+{
+    std::array< F, max_exact_power_ + 1 > powers_of_ten_{};
+    F power_of_ten_ = F(1);
+    for (F & p : powers_of_ten_) {
+        p = power_of_ten_;
+        power_of_ten_ *= F(10);
+    }
+    return powers_of_ten_;
+}
+
+constexpr std::array< F, max_exact_power_ + 1 > powers_of_ten_ = make_powers_of_ten();
+
+float
+strto(char const * const _literal, float)
+{
+    return std::strtof(_literal, nullptr);
+}
+
+double
+strto(char const * const _literal, double)
+{
+    return std::strtod(_literal, nullptr);
+}
+
+long double
+strto(char const * const _literal, long double)
+{
+    return std::strtold(_literal, nullptr);
+}
+
+}
+
+std::experimental::optional< F >
+fast_path(bool const _negative, std::uint64_t const _mantissa, long const _exponent)
+{
+    if (_mantissa == 0) {
+        return _negative ? -F(0) : F(0);
+    }
+    if (max_exact_mantissa_ < _mantissa) {
+        return {};
+    }
+    if ((_exponent < -max_exact_power_) || (max_exact_power_ < _exponent)) {
+        return {};
+    }
+    F value_ = static_cast< F >(_mantissa);
+    if (_exponent < 0) {
+        value_ /= powers_of_ten_[static_cast< size_type >(-_exponent)];
+    } else {
+        value_ *= powers_of_ten_[static_cast< size_type >(_exponent)];
+    }
+    return _negative ? -value_ : value_;
+}
+
+F
+slow_path(std::string const & _literal)
+{
+    return strto(_literal.c_str(), F{});
+}
+
+}
+}
+}
@@ -0,0 +1,73 @@
+#include <insituc/parser/parser.hpp>
+#include <insituc/parser/split.hpp>
+#include <insituc/parser/retag.hpp>
+
+#include <insituc/utility/parallel_for.hpp>
+
+#include <vector>
+#include <iterator>
+#include <utility>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace parser
+{
+
+parse_result
+parse_parallel(base_iterator_type const & first, base_iterator_type const & last, size_type _concurrency)
+{
+    ranges chunks_; // line positions are counted once by the sequential pre-scan
+    {
+        input_iterator_type position_(first);
+        base_iterator_type chunk_ = first;
+        while (auto const entry_end_ = find_entry_end(chunk_, last)) {
+            input_iterator_type const chunk_begin_ = position_;
+            std::advance(position_, std::distance(chunk_, *entry_end_));
+            chunks_.emplace_back(chunk_begin_, position_);
+            chunk_ = *entry_end_;
+        }
+    }
+    if (chunks_.size() < 2) {
+        return parse(first, last);
+    }
+    size_type const chunk_count_ = chunks_.size();
+    std::vector< parse_result > results_(chunk_count_);
+    parallel_for(chunk_count_, _concurrency, [&] (size_type const i)
+    {
+        results_[i] = parse(chunks_[i].first, chunks_[i].second);
+    });
+    parse_result parse_result_;
+    input_iterator_type const beg(first);
+    input_iterator_type const end(last);
+    range program_range_;
+    for (size_type i = 0; i < chunk_count_; ++i) {
+        parse_result & chunk_result_ = results_[i];
+        if (!!chunk_result_.error_) {
+            auto & error_description_ = *chunk_result_.error_;
+            error_description_.first_ = beg;
+            error_description_.last_ = end;
+            parse_result_.error_ = std::move(chunk_result_.error_);
+            return parse_result_;
+        }
+        assert(!chunk_result_.ranges_.empty());
+        range const & chunk_program_range_ = chunk_result_.ranges_.back(); // program node of the chunk is annotated last
+        if (i == 0) {
+            program_range_.first = chunk_program_range_.first;
+        }
+        program_range_.second = chunk_program_range_.second;
+        chunk_result_.ranges_.pop_back();
+        for (ast::entry_definition & entry_ : chunk_result_.ast_.entries_) {
+            shift_tags(entry_, parse_result_.ranges_.size());
+        }
+        std::move(std::begin(chunk_result_.ranges_), std::end(chunk_result_.ranges_), std::back_inserter(parse_result_.ranges_));
+        parse_result_.ast_.append(std::move(chunk_result_.ast_));
+    }
+    parse_result_.ast_.tag_ = parse_result_.ranges_.size();
+    parse_result_.ranges_.push_back(std::move(program_range_));
+    return parse_result_;
+}
+
+}
+}
@@ -0,0 +1,127 @@
+#include <insituc/parser/pragma_parser.hpp>
+
+#include <experimental/optional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <cctype>
+
+namespace insituc
+{
+namespace parser
+{
+
+namespace
+{
+
+string_type
+trim(base_iterator_type first, base_iterator_type last)
+{
+    auto const is_space_ = [] (char_type const c) { return (std::isspace(static_cast< unsigned char >(c)) != 0); };
+    first = std::find_if_not(first, last, is_space_);
+    while ((first != last) && is_space_(*std::prev(last))) {
+        --last;
+    }
+    return {first, last};
+}
+
+std::experimental::optional< size_type >
+to_size(string_type const & _value)
+{
+    if (_value.empty() || !std::all_of(std::cbegin(_value), std::cend(_value), [] (char_type const c) { return ('0' <= c) && (c <= '9'); })) {
+        return {};
+    }
+    size_type size_ = 0;
+    for (char_type const c : _value) {
+        size_ = size_ * 10 + static_cast< size_type >(c - '0');
+    }
+    return size_;
+}
+
+std::experimental::optional< bool >
+to_flag(string_type const & _value)
+{
+    if (_value.empty() || (_value == "1")) {
+        return true;
+    } else if (_value == "0") {
+        return false;
+    }
+    return {};
+}
+
+bool
+set_option(ast::pragma_options & _options, string_type const & _key, string_type const & _value)
+{
+    if (_key == "fast_math") {
+        if (_value.empty()) {
+            _options.fast_math_ = 2;
+        } else if (auto const level_ = to_size(_value)) {
+            if (2 < *level_) {
+                return false;
+            }
+            _options.fast_math_ = level_;
+        } else {
+            return false;
+        }
+    } else if ((_key == "inline") || (_key == "noinline")) {
+        auto const flag_ = to_flag(_value);
+        if (!flag_) {
+            return false;
+        }
+        _options.inline_ = (*flag_ == (_key == "inline"));
+    } else if ((_key == "vectorize") || (_key == "novectorize")) {
+        auto const flag_ = to_flag(_value);
+        if (!flag_) {
+            return false;
+        }
+        _options.vectorize_ = (*flag_ == (_key == "vectorize"));
+    } else if (_key == "precision") {
+        auto const precision_ = to_size(_value);
+        if (!precision_) {
+            return false;
+        }
+        _options.precision_ = precision_;
+    } else if (_key == "backend") {
+        if (_value == "interpreter") {
+            _options.backend_ = ast::backend::interpreter;
+        } else if (_value == "jit") {
+            _options.backend_ = ast::backend::jit;
+        } else {
+            return false;
+        }
+    } else if (_key == "drop") {
+        auto const drop_ = to_size(_value);
+        if (!drop_) {
+            return false;
+        }
+        _options.drop_ = *drop_;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}
+
+ast::pragma_options
+parse_pragma(string_type const & _record)
+{
+    ast::pragma_options options_;
+    base_iterator_type item_ = std::cbegin(_record);
+    base_iterator_type const end_ = std::cend(_record);
+    while (item_ != end_) {
+        base_iterator_type const item_end_ = std::find(item_, end_, ';');
+        base_iterator_type const assign_ = std::find(item_, item_end_, '=');
+        string_type key_ = trim(item_, assign_);
+        string_type value_ = ((assign_ == item_end_) ? string_type{} : trim(std::next(assign_), item_end_));
+        if (!key_.empty() && !set_option(options_, key_, value_)) {
+            options_.unknown_.emplace(std::move(key_), std::move(value_));
+        }
+        item_ = ((item_end_ == end_) ? end_ : std::next(item_end_));
+    }
+    return options_;
+}
+
+}
+}
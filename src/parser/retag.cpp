@@ -0,0 +1,157 @@
+#include <insituc/parser/retag.hpp>
+
+#include <versatile/visit.hpp>
+
+namespace insituc
+{
+namespace parser
+{
+
+namespace
+{
+
+struct retagger
+{
+
+    size_type const offset_;
+
+    void
+    shift(size_type & _tag) const
+    {
+        if (_tag != ast::ntag) {
+            _tag += offset_;
+        }
+    }
+
+    void
+    retag(ast::empty const & /*_empty*/) const
+    { ; }
+
+    void
+    retag(G const & /*_value*/) const
+    { ; }
+
+    void
+    retag(ast::constant const /*_constant*/) const
+    { ; }
+
+    void
+    retag(ast::operand_cptr const /*_operand_cptr*/) const
+    { ; }
+
+    void
+    retag(ast::identifier & _identifier) const
+    {
+        shift(_identifier.tag_);
+    }
+
+    void
+    retag(ast::lvalue_list & _lvalue_list) const
+    {
+        for (ast::lvalue & lvalue_ : _lvalue_list.lvalues_) {
+            retag(lvalue_);
+        }
+        shift(_lvalue_list.tag_);
+    }
+
+    void
+    retag(ast::rvalue_list & _rvalue_list) const
+    {
+        for (ast::rvalue & rvalue_ : _rvalue_list.rvalues_) {
+            operator () (rvalue_);
+        }
+        shift(_rvalue_list.pragma_.tag_);
+        shift(_rvalue_list.tag_);
+    }
+
+    void
+    retag(ast::intrinsic_invocation & _ast) const
+    {
+        retag(_ast.argument_list_);
+        shift(_ast.tag_);
+    }
+
+    void
+    retag(ast::entry_substitution & _ast) const
+    {
+        retag(_ast.entry_name_);
+        retag(_ast.argument_list_);
+        shift(_ast.tag_);
+    }
+
+    void
+    retag(ast::unary_expression & _ast) const
+    {
+        operator () (_ast.operand_);
+    }
+
+    void
+    retag(ast::binary_expression & _ast) const
+    {
+        operator () (_ast.lhs_);
+        operator () (_ast.rhs_);
+    }
+
+    void
+    retag(ast::expression & _expression) const
+    {
+        operator () (_expression.first_);
+        for (ast::operation & operation_ : _expression.rest_) {
+            operator () (operation_.operand_);
+        }
+        shift(_expression.tag_);
+    }
+
+    void
+    operator () (ast::operand & _operand) const
+    {
+        visit([&] (auto & o) { retag(o); }, *_operand);
+    }
+
+    void
+    retag(ast::variable_declaration & _ast) const
+    {
+        retag(_ast.lhs_);
+        retag(_ast.rhs_);
+        shift(_ast.tag_);
+    }
+
+    void
+    retag(ast::assignment & _ast) const
+    {
+        retag(_ast.lhs_);
+        retag(_ast.rhs_);
+        shift(_ast.tag_);
+    }
+
+    void
+    retag(ast::statement_block & _ast) const
+    {
+        for (ast::statement & statement_ : _ast.statements_) {
+            visit([&] (auto & s) { retag(s); }, *statement_);
+        }
+        shift(_ast.tag_);
+    }
+
+    void
+    operator () (ast::entry_definition & _entry) const
+    {
+        retag(_entry.entry_name_);
+        retag(_entry.argument_list_);
+        retag(_entry.body_);
+        retag(_entry.return_statement_);
+        shift(_entry.tag_);
+    }
+
+};
+
+}
+
+void
+shift_tags(ast::entry_definition & _entry, size_type const _offset)
+{
+    retagger{_offset}(_entry);
+}
+
+}
+}
@@ -0,0 +1,140 @@
+#include <insituc/parser/stream.hpp>
+
+#include <insituc/parser/parser.hpp>
+#include <insituc/parser/split.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace insituc
+{
+namespace parser
+{
+
+namespace
+{
+
+#if defined(__linux__)
+
+struct mapped_file
+{
+
+    explicit
+    mapped_file(std::string const & _filename)
+    {
+        int const fd_ = ::open(_filename.c_str(), O_RDONLY);
+        if (fd_ == -1) {
+            return;
+        }
+        struct ::stat stat_;
+        if (::fstat(fd_, &stat_) == 0) {
+            size_ = static_cast< size_type >(stat_.st_size);
+            if (size_ == 0) {
+                is_open_ = true;
+            } else {
+                void * const p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+                if (p != MAP_FAILED) {
+                    ::madvise(p, size_, MADV_SEQUENTIAL);
+                    data_ = static_cast< char_type const * >(p);
+                    is_open_ = true;
+                }
+            }
+        }
+        ::close(fd_);
+    }
+
+    mapped_file(mapped_file const &) = delete;
+    mapped_file & operator = (mapped_file const &) = delete;
+
+    ~mapped_file()
+    {
+        if (data_) {
+            ::munmap(const_cast< char_type * >(data_), size_);
+        }
+    }
+
+    bool is_open() const { return is_open_; }
+    char_type const * begin() const { return data_; }
+    char_type const * end() const { return data_ + size_; }
+
+private :
+
+    char_type const * data_ = nullptr;
+    size_type size_ = 0;
+    bool is_open_ = false;
+
+};
+
+#else
+
+struct mapped_file // fallback: the file is read at once
+{
+
+    explicit
+    mapped_file(std::string const & _filename)
+    {
+        std::ifstream ifs_(_filename, std::ios_base::binary);
+        if (!ifs_) {
+            return;
+        }
+        data_.assign(std::istreambuf_iterator< char_type >(ifs_), std::istreambuf_iterator< char_type >());
+        is_open_ = true;
+    }
+
+    bool is_open() const { return is_open_; }
+    char_type const * begin() const { return data_.data(); }
+    char_type const * end() const { return data_.data() + data_.size(); }
+
+private :
+
+    std::vector< char_type > data_;
+    bool is_open_ = false;
+
+};
+
+#endif
+
+}
+
+std::experimental::optional< std::string >
+parse_file(std::string const & _filename, entry_consumer const & _consumer)
+{
+    mapped_file const file_(_filename);
+    if (!file_.is_open()) {
+        return "can't open file \"" + _filename + "\"";
+    }
+    size_type line_ = 1;
+    char_type const * first_ = file_.begin();
+    char_type const * const last_ = file_.end();
+    while (auto const entry_end_ = find_entry_end(first_, last_)) {
+        string_type const source_(first_, *entry_end_); // only the current entry is held
+        auto parse_result_ = parse(std::cbegin(source_), std::cend(source_));
+        if (!!parse_result_.error_) {
+            auto const & error_description_ = *parse_result_.error_;
+            size_type const error_line_ = line_ + boost::spirit::get_line(error_description_.where_) - 1;
+            return std::to_string(error_line_) + ": " + error_description_.which_;
+        }
+        for (ast::entry_definition & entry_ : parse_result_.ast_.entries_) {
+            if (!_consumer(std::move(entry_))) {
+                return std::to_string(line_) + ": entry is rejected by consumer";
+            }
+        }
+        line_ += static_cast< size_type >(std::count(first_, *entry_end_, '\n'));
+        first_ = *entry_end_;
+    }
+    return {};
+}
+
+}
+}
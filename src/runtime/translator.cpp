@@ -622,6 +622,12 @@ translator::translate(mnemocode const _mnemocode,
     switch (_mnemocode) {
 #pragma clang diagnostic pop
     case mnemocode::call : {
+        assert(assembler_);
+        meta::function const & callee_function_ = assembler_->get_function(_destination);
+        if (is_inlined(callee_function_)) {
+            assert(callee_function_.climbing_ == _source);
+            return translate_inlined(callee_function_);
+        }
         stack_pointer_ += _source;
         // E8 cd CALL rel32 M Valid Valid Call near, relative, displacement relative to
         // next instruction. 32-bit displacement sign
@@ -3,9 +3,11 @@
 #include <insituc/transform/derivator/intrinsic.hpp>
 
 #include <insituc/transform/evaluator/evaluator.hpp>
+#include <insituc/transform/optimizer/canonicalize.hpp>
 #include <insituc/transform/derivator/context.hpp>
 #include <insituc/utility/reverse.hpp>
 #include <insituc/utility/append.hpp>
+#include <insituc/utility/parallel_for.hpp>
 
 #if defined(_DEBUG) || defined(DEBUG)
 #include <insituc/ast/io.hpp>
@@ -13,6 +15,9 @@
 
 #include <versatile/visit.hpp>
 
+#include <set>
+#include <vector>
+#include <iterator>
 #include <utility>
 #include <functional>
 #include <stdexcept>
@@ -386,80 +391,184 @@ private :
         return entry_;
     }
 
-    struct is_target
+public :
+
+    struct derivation
     {
 
-        ast::symbol const & symbol_;
-        ast::symbols const & wrts_;
+        derivative_cache & cache_;
+        ast::entries * const output_; // not needed, if the cache is released afterwards
+        std::set< derivative_cache::key > emitted_ = {}; // in the output_
+        std::deque< derivative_cache::key > emission_ = {}; // keys of the output_ entries
 
-        bool
-        operator () (ast::entry_definition const & _entry) const
-        {
-            if (!(symbol_ == _entry.entry_name_.symbol_)) {
-                return false;
+        void
+        emit(derivative_cache::key const & _key, derivative_cache::derivative const & _derivative)
+        { // lower order derivative and callees first, as if the derivative is derived right now
+            if (!output_) {
+                return;
+            }
+            if (!emitted_.insert(_key).second) {
+                return;
             }
-            if (!(wrts_ == _entry.entry_name_.wrts_)) {
-                return false;
+            if (2 < _key.size()) {
+                derivative_cache::key lower_(std::cbegin(_key), std::prev(std::cend(_key)));
+                if (derivative_cache::derivative const * const l = cache_.find_derivative(lower_)) {
+                    emit(lower_, *l);
+                }
+            }
+            for (derivative_cache::key const & callee_ : _derivative.callees_) {
+                if (derivative_cache::derivative const * const c = cache_.find_derivative(callee_)) {
+                    emit(callee_, *c);
+                }
             }
-            return true;
+            output_->push_back(_derivative.entry_);
+            emission_.push_back(_key);
         }
 
     };
 
-public :
-
     ast::entry_definition const *
-    operator () (ast::entries const & _primitives, ast::entries & _derivatives,
+    operator () (derivation & _derivation,
                  ast::symbol const &_target, ast::symbols _wrts)
     {
-        is_target const is_target_{_target, _wrts};
-        for (ast::entry_definition const & primitive_ : reverse(_primitives)) {
-            if (is_target_(primitive_)) {
-                descriptor_.push(std::move(_wrts));
-                return &primitive_;
-            }
+        derivative_cache & cache_ = _derivation.cache_;
+        derivative_cache::key key_ = cache_.intern(_target, _wrts);
+        if (auto const * const primitive_ = cache_.find_primitive(key_)) {
+            descriptor_.push(std::move(_wrts));
+            return primitive_;
         }
         if (_wrts.empty()) {
             throw std::runtime_error("wrts is empty but symbol " + _target.name_ + " is not primitive");
         }
-        for (ast::entry_definition const & derivative_ : reverse(_derivatives)) {
-            if (is_target_(derivative_)) {
-                descriptor_.push(std::move(_wrts));
-                return &derivative_;
-            }
+        if (auto const * const cached_ = cache_.find_derivative(key_)) {
+            _derivation.emit(key_, *cached_);
+            descriptor_.push(std::move(_wrts));
+            return &cached_->entry_;
         }
         ast::symbol wrt_ = std::move(_wrts.back());
         _wrts.pop_back();
-        auto const * p = (derivator{descriptor_})(_primitives, _derivatives, _target, std::move(_wrts));
+        auto const * p = (derivator{descriptor_})(_derivation, _target, std::move(_wrts));
         if (!p) {
             throw std::runtime_error("can't derive primitive " + _target.name_);
         }
         descriptor_.push(std::move(wrt_));
-        ast::entry_definition derivative_ = evaluate(derive(*p));
+        derivative_cache::derivative derivative_{evaluate(canonicalize(evaluate(derive(*p)))), {}}; // swell of the higher order derivatives is reduced on each order
         { // callies first
             for (ast::identifier & callee_ : callies_) {
+                derivative_cache::key callee_key_ = cache_.intern(callee_.symbol_, callee_.wrts_);
                 descriptor callee_descriptor_;
-                auto const * c = (derivator{callee_descriptor_})(_primitives, _derivatives, callee_.symbol_, std::move(callee_.wrts_));
+                auto const * c = (derivator{callee_descriptor_})(_derivation, callee_.symbol_, std::move(callee_.wrts_));
                 if (!c) {
                     throw std::runtime_error("can't derive callee " + callee_.symbol_.name_);
                 }
+                derivative_.callees_.push_back(std::move(callee_key_));
             }
         }
-        _derivatives.push_back(std::move(derivative_)); // caller last
-        return &_derivatives.back();
+        auto const & inserted_ = cache_.insert(derivative_cache::key(key_), std::move(derivative_));
+        _derivation.emit(key_, inserted_); // caller last
+        return &inserted_.entry_;
     }
 
 };
 
+derivative_cache::derivative_cache(ast::program const & _primitives)
+    : primitives_(_primitives)
+{
+    for (ast::entry_definition const & entry_ : _primitives.entries_) {
+        primitive_entries_[intern(entry_.entry_name_.symbol_, entry_.entry_name_.wrts_)] = &entry_; // the last definition wins
+    }
+}
+
+auto
+derivative_cache::intern(ast::symbol const & _function, ast::symbols const & _wrts)
+-> key
+{
+    std::lock_guard< std::mutex > const lock_{mutex_};
+    auto const intern_ = [&] (ast::symbol const & _symbol) -> size_type
+    {
+        return symbols_.emplace(_symbol, symbols_.size()).first->second;
+    };
+    key key_;
+    key_.reserve(1 + _wrts.size());
+    key_.push_back(intern_(_function));
+    for (ast::symbol const & wrt_ : _wrts) {
+        key_.push_back(intern_(wrt_));
+    }
+    return key_;
+}
+
+ast::entry_definition const *
+derivative_cache::find_primitive(key const & _key) const
+{
+    auto const primitive_ = primitive_entries_.find(_key);
+    if (primitive_ == std::end(primitive_entries_)) {
+        return nullptr;
+    }
+    return primitive_->second;
+}
+
+auto
+derivative_cache::find_derivative(key const & _key) const
+-> derivative const *
+{
+    std::lock_guard< std::mutex > const lock_{mutex_};
+    auto const derivative_ = derivatives_.find(_key);
+    if (derivative_ == std::end(derivatives_)) {
+        return nullptr;
+    }
+    return &derivative_->second;
+}
+
+auto
+derivative_cache::insert(key && _key, derivative && _derivative)
+-> derivative const &
+{
+    std::lock_guard< std::mutex > const lock_{mutex_};
+    auto const inserted_ = derivatives_.emplace(_key, std::move(_derivative)); // derived concurrently by another thread otherwise
+    if (inserted_.second) {
+        order_.push_back(std::move(_key));
+    }
+    return inserted_.first->second;
+}
+
+void
+derivative_cache::reorder(size_type const _first, std::deque< key > const & _keys)
+{
+    std::lock_guard< std::mutex > const lock_{mutex_};
+    assert(_first <= order_.size());
+    std::set< key > unordered_(std::next(std::cbegin(order_), _first), std::cend(order_));
+    order_.resize(_first);
+    for (key const & key_ : _keys) {
+        if (unordered_.erase(key_) != 0) {
+            order_.push_back(key_);
+        }
+    }
+    assert(unordered_.empty()); // every derivative is emitted by some derivation
+}
+
 ast::program
-derive(ast::program const & _primitives,
+derivative_cache::release()
+{
+    std::lock_guard< std::mutex > const lock_{mutex_};
+    ast::program program_;
+    for (key const & key_ : order_) { // moving of an entry does not relocate its operands, so references to them stay valid
+        program_.append(std::move(derivatives_.at(key_).entry_));
+    }
+    derivatives_.clear();
+    order_.clear();
+    return program_;
+}
+
+ast::program
+derive(derivative_cache & _cache,
        ast::identifier _target)
 {
-    assert(!_primitives.entries_.empty());
+    assert(!_cache.primitives().entries_.empty());
+    auto const lock_ = _cache.share_derivation();
     ast::program derivatives_;
+    derivator::derivation derivation_{_cache, &derivatives_.entries_};
     descriptor descriptor_;
-    auto const * d = (derivator{descriptor_})(_primitives.entries_, derivatives_.entries_,
-                                              std::move(_target.symbol_), std::move(_target.wrts_));
+    auto const * d = (derivator{descriptor_})(derivation_, _target.symbol_, std::move(_target.wrts_));
     if (!d) {
         throw std::runtime_error("can't derive  " + _target.symbol_.name_);
     }
@@ -467,18 +576,19 @@ derive(ast::program const & _primitives,
 }
 
 ast::program
-derive(ast::program const & _primitives,
+derive(derivative_cache & _cache,
        ast::symbols _targets,
        ast::symbols const & _wrts)
 {
-    assert(!_primitives.entries_.empty());
+    assert(!_cache.primitives().entries_.empty());
     assert(!_targets.empty());
     assert(!_wrts.empty());
+    auto const lock_ = _cache.share_derivation();
     ast::program derivatives_;
+    derivator::derivation derivation_{_cache, &derivatives_.entries_};
     for (ast::symbol & target_ : _targets) {
         descriptor descriptor_;
-        auto const * d = (derivator{descriptor_})(_primitives.entries_, derivatives_.entries_,
-                                                  target_, _wrts);
+        auto const * d = (derivator{descriptor_})(derivation_, target_, _wrts);
         if (!d) {
             throw std::runtime_error("can't derive " + target_.name_);
         }
@@ -486,6 +596,54 @@ derive(ast::program const & _primitives,
     return derivatives_;
 }
 
+ast::program
+derive(derivative_cache & _cache,
+       ast::symbols const & _wrts)
+{
+    assert(!_cache.primitives().entries_.empty());
+    assert(!_wrts.empty());
+    ast::symbols targets_;
+    for (ast::entry_definition const & entry_ : _cache.primitives().entries_) {
+        targets_.push_back(entry_.entry_name_.symbol_);
+    }
+    return derive(_cache, std::move(targets_), _wrts);
+}
+
+ast::program
+derive(ast::program const & _primitives,
+       ast::identifier _target)
+{
+    assert(!_primitives.entries_.empty());
+    derivative_cache cache_{_primitives};
+    derivator::derivation derivation_{cache_, nullptr};
+    descriptor descriptor_;
+    auto const * d = (derivator{descriptor_})(derivation_, _target.symbol_, std::move(_target.wrts_));
+    if (!d) {
+        throw std::runtime_error("can't derive  " + _target.symbol_.name_);
+    }
+    return cache_.release();
+}
+
+ast::program
+derive(ast::program const & _primitives,
+       ast::symbols _targets,
+       ast::symbols const & _wrts)
+{
+    assert(!_primitives.entries_.empty());
+    assert(!_targets.empty());
+    assert(!_wrts.empty());
+    derivative_cache cache_{_primitives};
+    derivator::derivation derivation_{cache_, nullptr};
+    for (ast::symbol & target_ : _targets) {
+        descriptor descriptor_;
+        auto const * d = (derivator{descriptor_})(derivation_, target_, _wrts);
+        if (!d) {
+            throw std::runtime_error("can't derive " + target_.name_);
+        }
+    }
+    return cache_.release();
+}
+
 ast::program
 derive(ast::program const & _primitives,
        ast::symbols const & _wrts)
@@ -499,5 +657,91 @@ derive(ast::program const & _primitives,
     return derive(_primitives, std::move(targets_), _wrts);
 }
 
+namespace
+{
+
+ast::programs
+derive_concurrently(derivative_cache & _cache,
+                    ast::symbols const & _targets,
+                    std::deque< ast::symbols > const & _columns,
+                    size_type _concurrency)
+{ // each (column, target) pair is derived by its own derivation
+    auto const lock_ = _cache.own_derivation(); // no other derivation may insert between first_ and reorder
+    size_type const first_ = _cache.size();
+    size_type const target_count_ = _targets.size();
+    size_type const unit_count_ = _columns.size() * target_count_;
+    std::vector< ast::program > derivatives_(unit_count_);
+    std::vector< std::deque< derivative_cache::key > > emissions_(unit_count_);
+    parallel_for(unit_count_, _concurrency, [&] (size_type const i)
+    {
+        ast::symbol const & target_ = _targets[i % target_count_];
+        derivator::derivation derivation_{_cache, &derivatives_[i].entries_};
+        descriptor descriptor_;
+        auto const * d = (derivator{descriptor_})(derivation_, target_, _columns[i / target_count_]);
+        if (!d) {
+            throw std::runtime_error("can't derive " + target_.name_);
+        }
+        emissions_[i] = std::move(derivation_.emission_);
+    });
+    ast::programs programs_; // a column is merged in order of the targets, each derivative is emitted once as by a single derivation
+    std::deque< derivative_cache::key > emission_;
+    for (size_type i = 0; i < unit_count_; i += target_count_) {
+        ast::program program_;
+        std::set< derivative_cache::key > emitted_;
+        for (size_type j = i; j < i + target_count_; ++j) {
+            auto key_ = std::begin(emissions_[j]);
+            for (ast::entry_definition & entry_ : derivatives_[j].entries_) {
+                if (emitted_.insert(*key_).second) {
+                    program_.append(std::move(entry_));
+                    emission_.push_back(std::move(*key_));
+                }
+                ++key_;
+            }
+        }
+        programs_.push_back(std::move(program_));
+    }
+    _cache.reorder(first_, emission_);
+    return programs_;
+}
+
+}
+
+ast::program
+derive_parallel(derivative_cache & _cache,
+                ast::symbols const & _targets,
+                ast::symbols const & _wrts,
+                size_type _concurrency)
+{
+    assert(!_cache.primitives().entries_.empty());
+    assert(!_targets.empty());
+    assert(!_wrts.empty());
+    return std::move(derive_concurrently(_cache, _targets, {_wrts}, _concurrency).front());
+}
+
+ast::programs
+derive_columns_parallel(derivative_cache & _cache,
+                        std::deque< ast::symbols > const & _columns,
+                        size_type _concurrency)
+{
+    assert(!_cache.primitives().entries_.empty());
+    ast::symbols targets_;
+    for (ast::entry_definition const & entry_ : _cache.primitives().entries_) {
+        targets_.push_back(entry_.entry_name_.symbol_);
+    }
+    return derive_concurrently(_cache, targets_, _columns, _concurrency);
+}
+
+ast::program
+derive_parallel(ast::program const & _primitives,
+                ast::symbols const & _targets,
+                ast::symbols const & _wrts,
+                size_type _concurrency)
+{
+    assert(!_primitives.entries_.empty());
+    derivative_cache cache_{_primitives};
+    derive_parallel(cache_, _targets, _wrts, _concurrency);
+    return cache_.release();
+}
+
 }
 }
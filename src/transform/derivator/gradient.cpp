@@ -0,0 +1,706 @@
+#include <insituc/transform/derivator/gradient.hpp>
+
+#include <insituc/transform/derivator/intrinsic.hpp>
+#include <insituc/transform/derivator/sparsity.hpp>
+
+#include <insituc/transform/evaluator/evaluator.hpp>
+#include <insituc/transform/optimizer/dependencies.hpp>
+#include <insituc/transform/optimizer/cse.hpp>
+#include <insituc/ast/compare.hpp>
+#include <insituc/utility/reverse.hpp>
+#include <insituc/utility/append.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <map>
+#include <set>
+#include <deque>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace transform
+{
+
+namespace
+{
+
+using B = ast::binary_expression;
+using U = ast::unary_expression;
+
+struct accumulation
+{
+
+    struct partial
+    {
+
+        ast::identifier argument_;
+        ast::operand value_;
+
+    };
+
+    using partials = std::deque< partial >;
+
+    struct record
+    {
+
+        ast::lvalues results_;
+        std::deque< partials > partials_; // for each of the results
+
+    };
+
+    std::set< string_type > names_;
+    size_type tape_index_ = 0;
+    size_type adjoint_index_ = 0;
+    size_type tangent_index_ = 0;
+
+    std::deque< std::map< ast::identifier, ast::rvalue > > scopes_; // values bound to the local variables and arguments
+    std::deque< record > tape_;
+    ast::statements statements_;
+
+    // names
+
+    void
+    collect(ast::rvalues const & _rvalues)
+    {
+        std::set< ast::identifier > identifiers_;
+        dependencies{identifiers_}(_rvalues);
+        for (ast::identifier const & identifier_ : identifiers_) {
+            names_.insert(identifier_.symbol_.name_);
+        }
+    }
+
+    void
+    collect(ast::lvalues const & _lvalues)
+    {
+        for (ast::lvalue const & lvalue_ : _lvalues) {
+            names_.insert(lvalue_.symbol_.name_);
+        }
+    }
+
+    void
+    collect_statement(ast::empty const & /*_empty*/)
+    {
+
+    }
+
+    void
+    collect_statement(ast::variable_declaration const & _ast)
+    {
+        collect(_ast.lhs_.lvalues_);
+        collect(_ast.rhs_.rvalues_);
+    }
+
+    void
+    collect_statement(ast::assignment const & _assignment)
+    {
+        collect(_assignment.lhs_.lvalues_);
+        collect(_assignment.rhs_.rvalues_);
+    }
+
+    void
+    collect_statement(ast::statement_block const & _statement_block)
+    {
+        collect(_statement_block.statements_);
+    }
+
+    void
+    collect(ast::statements const & _statements)
+    {
+        for (ast::statement const & statement_ : _statements) {
+            visit([&] (auto const & s) { collect_statement(s); }, *statement_);
+        }
+    }
+
+    ast::identifier
+    make_hidden(string_type const & _prefix, size_type & _index)
+    {
+        ast::identifier hidden_;
+        do {
+            hidden_.symbol_.name_ = _prefix + std::to_string(_index++);
+        } while (names_.find(hidden_.symbol_.name_) != std::end(names_));
+        return hidden_;
+    }
+
+    // forward sweep: the tape of intermediate values
+
+    static
+    void
+    contribute(partials & _partials, ast::rvalue const & _argument, ast::operand && _value)
+    {
+        if (auto const * const identifier_ = get< ast::identifier >(&_argument)) { // values are constant
+            _partials.push_back({*identifier_, std::move(_value)});
+        }
+    }
+
+    ast::rvalues
+    record_values(ast::lvalues && _results, ast::operand && _definition, std::deque< partials > && _partials)
+    {
+        assert(_results.size() == _partials.size());
+        ast::rvalues values_;
+        for (ast::lvalue const & result_ : _results) {
+            values_.push_back(result_);
+        }
+        statements_.push_back(ast::variable_declaration{{_results}, {append< ast::rvalues >(std::move(_definition))}});
+        tape_.push_back({std::move(_results), std::move(_partials)});
+        return values_;
+    }
+
+    static
+    ast::rvalue
+    scalar(ast::rvalues && _values)
+    {
+        if (_values.size() != 1) {
+            throw std::runtime_error("list of values is not allowed in scalar context");
+        }
+        return std::move(_values.back());
+    }
+
+    ast::rvalues
+    record_binary(ast::rvalue const & _lhs, ast::binary const _operator, ast::rvalue const & _rhs)
+    {
+        ast::identifier result_ = make_hidden("_t", tape_index_);
+        partials partials_;
+        switch (_operator) {
+        case ast::binary::add : {
+            contribute(partials_, _lhs, ast::constant::one);
+            contribute(partials_, _rhs, ast::constant::one);
+            break;
+        }
+        case ast::binary::sub : {
+            contribute(partials_, _lhs, ast::constant::one);
+            contribute(partials_, _rhs, U{ast::unary::minus, ast::constant::one});
+            break;
+        }
+        case ast::binary::mul : {
+            contribute(partials_, _lhs, ast::operand{_rhs});
+            contribute(partials_, _rhs, ast::operand{_lhs});
+            break;
+        }
+        case ast::binary::div : {
+            contribute(partials_, _lhs, B{ast::constant::one, ast::binary::div, _rhs});
+            contribute(partials_, _rhs, U{ast::unary::minus, B{result_, ast::binary::div, _rhs}});
+            break;
+        }
+        case ast::binary::mod : {
+            contribute(partials_, _lhs, ast::constant::one);
+            contribute(partials_, _rhs, U{ast::unary::minus, ast::intrinsic_invocation{ast::intrinsic::trunc, {append< ast::rvalues >(B{_lhs, ast::binary::div, _rhs})}}});
+            break;
+        }
+        case ast::binary::pow : {
+            contribute(partials_, _lhs, B{result_, ast::binary::mul, B{_rhs, ast::binary::div, _lhs}});
+            contribute(partials_, _rhs, B{result_, ast::binary::mul, ast::intrinsic_invocation{ast::intrinsic::ln, {append< ast::rvalues >(_lhs)}}});
+            break;
+        }
+        }
+        return record_values(append< ast::lvalues >(std::move(result_)), B{_lhs, _operator, _rhs}, append< std::deque< partials > >(std::move(partials_)));
+    }
+
+    ast::rvalues
+    record_intrinsic(ast::intrinsic const _intrinsic, ast::rvalues && _arguments)
+    {
+        auto const unit_ = [&] (size_type const _index) -> ast::rvalues
+        {
+            ast::rvalues darguments_;
+            for (size_type i = 0; i < _arguments.size(); ++i) {
+                darguments_.push_back((i == _index) ? ast::constant::one : ast::constant::zero);
+            }
+            return darguments_;
+        };
+        size_type const result_count_ = derive_intrinsic(_intrinsic, ast::rvalues(_arguments), unit_(_arguments.size())).size();
+        std::deque< partials > partials_(result_count_);
+        for (size_type i = 0; i < _arguments.size(); ++i) {
+            if (!_arguments[i].active< ast::identifier >()) {
+                continue;
+            }
+            ast::rvalues derivatives_ = derive_intrinsic(_intrinsic, ast::rvalues(_arguments), unit_(i)); // column of the local Jacobian
+            assert(derivatives_.size() == result_count_);
+            for (size_type r = 0; r < result_count_; ++r) {
+                contribute(partials_[r], _arguments[i], std::move(derivatives_[r]));
+            }
+        }
+        ast::lvalues results_;
+        for (size_type r = 0; r < result_count_; ++r) {
+            results_.push_back(make_hidden("_t", tape_index_));
+        }
+        return record_values(std::move(results_), ast::intrinsic_invocation{_intrinsic, {std::move(_arguments)}}, std::move(partials_));
+    }
+
+    ast::rvalue const *
+    lookup(ast::identifier const & _identifier) const
+    {
+        for (auto const & scope_ : reverse(scopes_)) { // from inner scopes to outer
+            auto const binding_ = scope_.find(_identifier);
+            if (binding_ != std::end(scope_)) {
+                return &binding_->second;
+            }
+        }
+        return nullptr;
+    }
+
+    [[noreturn]]
+    ast::rvalues
+    linearize_operand(ast::empty const & /*_empty*/)
+    {
+        throw std::runtime_error("empty expression cannot be derived");
+    }
+
+    ast::rvalues
+    linearize_operand(G const & _value)
+    {
+        return append< ast::rvalues >(_value);
+    }
+
+    ast::rvalues
+    linearize_operand(ast::constant const _constant)
+    {
+        return append< ast::rvalues >(_constant);
+    }
+
+    ast::rvalues
+    linearize_operand(ast::intrinsic_invocation const & _ast)
+    {
+        return record_intrinsic(_ast.intrinsic_, linearize(_ast.argument_list_.rvalues_));
+    }
+
+    [[noreturn]]
+    ast::rvalues
+    linearize_operand(ast::entry_substitution const & /*_ast*/)
+    {
+        throw std::runtime_error("entry substitution cannot be derived in reverse mode");
+    }
+
+    ast::rvalues
+    linearize_operand(ast::identifier const & _identifier)
+    {
+        if (ast::rvalue const * const value_ = lookup(_identifier)) {
+            return append< ast::rvalues >(*value_);
+        }
+        return append< ast::rvalues >(_identifier); // global variable
+    }
+
+    ast::rvalues
+    linearize_operand(ast::unary_expression const & _ast)
+    {
+        ast::rvalues operand_ = linearize(_ast.operand_);
+        switch (_ast.operator_) {
+        case ast::unary::plus : {
+            return operand_;
+        }
+        case ast::unary::minus : {
+            ast::rvalue value_ = scalar(std::move(operand_));
+            ast::identifier result_ = make_hidden("_t", tape_index_);
+            partials partials_;
+            contribute(partials_, value_, U{ast::unary::minus, ast::constant::one});
+            return record_values(append< ast::lvalues >(std::move(result_)), U{ast::unary::minus, std::move(value_)}, append< std::deque< partials > >(std::move(partials_)));
+        }
+        }
+    }
+
+    ast::rvalues
+    linearize_operand(ast::binary_expression const & _ast)
+    {
+        ast::rvalue lhs_ = scalar(linearize(_ast.lhs_));
+        return record_binary(lhs_, _ast.operator_, scalar(linearize(_ast.rhs_)));
+    }
+
+    ast::rvalues
+    linearize_operand(ast::expression const & _expression)
+    {
+        if (_expression.rest_.empty()) {
+            return linearize(_expression.first_);
+        } else if (_expression.rest_.size() == 1) {
+            ast::rvalue lhs_ = scalar(linearize(_expression.first_));
+            ast::operation const & rhs_ = _expression.rest_.back();
+            return record_binary(lhs_, rhs_.operator_, scalar(linearize(rhs_.operand_)));
+        } else {
+            throw std::logic_error("transform to binary form first");
+        }
+    }
+
+    ast::rvalues
+    linearize_operand(ast::rvalue_list const & _rvalue_list)
+    {
+        return linearize(_rvalue_list.rvalues_);
+    }
+
+    ast::rvalues
+    linearize_operand(ast::operand_cptr const _operand_cptr)
+    {
+        return linearize(*_operand_cptr);
+    }
+
+    ast::rvalues
+    linearize(ast::operand const & _operand)
+    {
+        return visit([&] (auto const & o) -> ast::rvalues
+        {
+            return linearize_operand(o);
+        }, *_operand);
+    }
+
+    ast::rvalues
+    linearize(ast::rvalues const & _rvalues)
+    {
+        ast::rvalues values_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            for (ast::rvalue & value_ : linearize(rvalue_)) {
+                values_.push_back(std::move(value_));
+            }
+        }
+        return values_;
+    }
+
+    void
+    linearize_statement(ast::empty const & /*_empty*/)
+    {
+
+    }
+
+    void
+    linearize_statement(ast::variable_declaration const & _ast)
+    {
+        ast::rvalues values_ = linearize(_ast.rhs_.rvalues_);
+        if (values_.size() != _ast.lhs_.lvalues_.size()) {
+            throw std::runtime_error("number of values does not match number of variables");
+        }
+        assert(!scopes_.empty());
+        auto value_ = std::begin(values_);
+        for (ast::lvalue const & lvalue_ : _ast.lhs_.lvalues_) {
+            scopes_.back()[lvalue_] = std::move(*value_++);
+        }
+    }
+
+    void
+    linearize_statement(ast::assignment const & _assignment)
+    { // each assignment of the local variable binds a new value to it
+        ast::rvalues values_ = linearize(_assignment.rhs_.rvalues_);
+        if (values_.size() != _assignment.lhs_.lvalues_.size()) {
+            throw std::runtime_error("number of values does not match number of variables");
+        }
+        auto value_ = std::begin(values_);
+        for (ast::lvalue const & lvalue_ : _assignment.lhs_.lvalues_) {
+            ast::rvalue * binding_ = nullptr;
+            for (auto & scope_ : reverse(scopes_)) {
+                auto const b = scope_.find(lvalue_);
+                if (b != std::end(scope_)) {
+                    binding_ = &b->second;
+                    break;
+                }
+            }
+            if (!binding_) {
+                throw std::runtime_error("assignment of the global variable " + lvalue_.symbol_.name_ + " cannot be derived in reverse mode");
+            }
+            if (_assignment.operator_ == ast::assign::assign) {
+                *binding_ = std::move(*value_);
+            } else {
+                *binding_ = scalar(record_binary(*binding_, ast::get_binary(_assignment.operator_), *value_));
+            }
+            ++value_;
+        }
+    }
+
+    void
+    linearize_statement(ast::statement_block const & _statement_block)
+    {
+        scopes_.emplace_back();
+        linearize(_statement_block.statements_);
+        scopes_.pop_back();
+    }
+
+    void
+    linearize(ast::statements const & _statements)
+    {
+        for (ast::statement const & statement_ : _statements) {
+            visit([&] (auto const & s) { linearize_statement(s); }, *statement_);
+        }
+    }
+
+    // reverse sweep: the adjoints
+
+    static
+    ast::operand
+    accumulate(ast::rvalues && _contributions)
+    {
+        assert(!_contributions.empty());
+        ast::operand sum_ = std::move(_contributions.front());
+        _contributions.pop_front();
+        for (ast::rvalue & contribution_ : _contributions) {
+            sum_ = B{std::move(sum_), ast::binary::add, std::move(contribution_)};
+        }
+        return sum_;
+    }
+
+    ast::operand
+    share(ast::operand && _value, string_type const & _prefix, size_type & _index)
+    { // non-trivial value used more then once is calculated into hidden local variable
+        if (_value.active< ast::identifier >() || _value.active< ast::constant >() || _value.active< G >()) {
+            return std::move(_value);
+        }
+        ast::identifier hidden_ = make_hidden(_prefix, _index);
+        statements_.push_back(ast::variable_declaration{{append< ast::lvalues >(hidden_)}, {append< ast::rvalues >(std::move(_value))}});
+        return std::move(hidden_);
+    }
+
+    ast::rvalues
+    linearize(ast::entry_definition const & _entry)
+    {
+        names_.insert(_entry.entry_name_.symbol_.name_);
+        collect(_entry.argument_list_.lvalues_);
+        collect(_entry.body_.statements_);
+        collect(_entry.return_statement_.rvalues_);
+        scopes_.emplace_back();
+        for (ast::lvalue const & argument_ : _entry.argument_list_.lvalues_) {
+            scopes_.back().emplace(argument_, argument_);
+        }
+        linearize(_entry.body_.statements_);
+        ast::rvalues values_ = linearize(_entry.return_statement_.rvalues_);
+        scopes_.pop_back();
+        return values_;
+    }
+
+    ast::rvalues
+    reverse_sweep(ast::rvalue const & _value, ast::symbols const & _wrts)
+    {
+        std::map< ast::identifier, ast::rvalues > contributions_;
+        if (auto const * const identifier_ = get< ast::identifier >(&_value)) {
+            contributions_[*identifier_].push_back(ast::constant::one);
+        }
+        for (record const & record_ : reverse(tape_)) {
+            auto partials_ = std::cbegin(record_.partials_);
+            for (ast::lvalue const & result_ : record_.results_) {
+                partials const & result_partials_ = *partials_++;
+                auto const contribution_ = contributions_.find(result_);
+                if (contribution_ == std::end(contributions_)) {
+                    continue; // the result is not used
+                }
+                ast::operand adjoint_ = share(accumulate(std::move(contribution_->second)), "_a", adjoint_index_); // shared by all the partials
+                contributions_.erase(contribution_);
+                for (partial const & partial_ : result_partials_) {
+                    contributions_[partial_.argument_].push_back(B{adjoint_, ast::binary::mul, partial_.value_});
+                }
+            }
+        }
+        ast::rvalues derivatives_;
+        for (ast::symbol const & wrt_ : _wrts) {
+            ast::identifier identifier_;
+            identifier_.symbol_ = wrt_;
+            auto const contribution_ = contributions_.find(identifier_);
+            if (contribution_ == std::end(contributions_)) {
+                derivatives_.push_back(ast::constant::zero);
+            } else {
+                derivatives_.push_back(accumulate(ast::rvalues(contribution_->second)));
+            }
+        }
+        return derivatives_;
+    }
+
+    ast::rvalues
+    forward_sweep(ast::rvalues const & _values, ast::symbols const & _seeds)
+    { // directional derivative: sum of the columns of _seeds
+        std::map< ast::identifier, ast::operand > tangents_;
+        for (ast::symbol const & seed_ : _seeds) {
+            ast::identifier identifier_;
+            identifier_.symbol_ = seed_;
+            tangents_.emplace(std::move(identifier_), ast::constant::one);
+        }
+        return forward_sweep(_values, std::move(tangents_));
+    }
+
+    ast::rvalues
+    forward_sweep(ast::rvalues const & _values, std::map< ast::identifier, ast::operand > && _tangents)
+    { // directional derivative along the given tangents of the inputs
+        std::map< ast::identifier, ast::operand > tangents_ = std::move(_tangents);
+        for (record const & record_ : tape_) {
+            auto partials_ = std::cbegin(record_.partials_);
+            for (ast::lvalue const & result_ : record_.results_) {
+                ast::rvalues terms_;
+                for (partial const & partial_ : *partials_++) {
+                    auto const tangent_ = tangents_.find(partial_.argument_);
+                    if (tangent_ != std::end(tangents_)) {
+                        terms_.push_back(B{partial_.value_, ast::binary::mul, tangent_->second});
+                    }
+                }
+                if (!terms_.empty()) { // otherwise the result does not depend on _wrt
+                    tangents_.emplace(result_, share(accumulate(std::move(terms_)), "_d", tangent_index_));
+                }
+            }
+        }
+        ast::rvalues derivatives_;
+        for (ast::rvalue const & value_ : _values) {
+            ast::identifier const * const identifier_ = get< ast::identifier >(&value_);
+            auto const tangent_ = (identifier_ ? tangents_.find(*identifier_) : std::end(tangents_));
+            if (tangent_ == std::end(tangents_)) {
+                derivatives_.push_back(ast::constant::zero);
+            } else {
+                derivatives_.push_back(tangent_->second);
+            }
+        }
+        return derivatives_;
+    }
+
+    std::map< ast::identifier, ast::operand >
+    seed(ast::symbols const & _wrts, ast::symbols const & _direction, ast::lvalues & _arguments)
+    { // components of the _direction are the tangents of the _wrts, they are passed as additional _arguments
+        if (_direction.size() != _wrts.size()) {
+            throw std::runtime_error("direction should have a component for each of wrts");
+        }
+        std::map< ast::identifier, ast::operand > tangents_;
+        for (size_type i = 0; i < _wrts.size(); ++i) {
+            if (!names_.insert(_direction[i].name_).second) {
+                throw std::runtime_error("name of direction component " + _direction[i].name_ + " is already in use");
+            }
+            ast::identifier wrt_;
+            wrt_.symbol_ = _wrts[i];
+            ast::identifier component_;
+            component_.symbol_ = _direction[i];
+            _arguments.push_back(component_);
+            if (!tangents_.emplace(std::move(wrt_), std::move(component_)).second) {
+                throw std::runtime_error("wrts should be distinct");
+            }
+        }
+        return tangents_;
+    }
+
+};
+
+}
+
+ast::entry_definition
+gradient(ast::entry_definition const & _entry,
+         ast::symbols const & _wrts,
+         ast::symbol _name)
+{
+    accumulation accumulation_;
+    ast::rvalue value_ = accumulation::scalar(accumulation_.linearize(_entry));
+    ast::rvalues derivatives_ = accumulation_.reverse_sweep(value_, _wrts);
+    ast::entry_definition entry_;
+    entry_.entry_name_.symbol_ = std::move(_name);
+    entry_.argument_list_ = _entry.argument_list_;
+    entry_.body_.statements_ = std::move(accumulation_.statements_);
+    entry_.return_statement_.rvalues_ = append< ast::rvalues >(std::move(value_));
+    for (ast::rvalue & derivative_ : derivatives_) {
+        entry_.return_statement_.rvalues_.push_back(std::move(derivative_));
+    }
+    return evaluate(std::move(entry_));
+}
+
+ast::entry_definition
+Jacobian(ast::entry_definition const & _function,
+         ast::symbols const & _wrts,
+         ast::symbol _name,
+         size_type const _output_limit,
+         ast::symbols const & _spill)
+{
+    accumulation accumulation_;
+    ast::rvalues values_ = accumulation_.linearize(_function);
+    // structurally orthogonal columns are derived together: the number of sweeps is the number of colours
+    sparsity_pattern const sparsity_pattern_ = get_sparsity_pattern(_function, _wrts);
+    column_colouring const column_colouring_ = colour_columns(sparsity_pattern_, _wrts.size());
+    std::deque< ast::symbols > seeds_;
+    for (size_type column_ = 0; column_ < _wrts.size(); ++column_) {
+        size_type const colour_ = column_colouring_[column_];
+        if (!(colour_ < seeds_.size())) {
+            seeds_.resize(colour_ + 1);
+        }
+        seeds_[colour_].push_back(_wrts[column_]);
+    }
+    std::deque< ast::rvalues > compressed_;
+    for (ast::symbols const & seed_ : seeds_) {
+        compressed_.push_back(accumulation_.forward_sweep(values_, seed_));
+    }
+    ast::rvalues results_ = values_;
+    for (size_type column_ = 0; column_ < _wrts.size(); ++column_) {
+        ast::rvalues const & compressed_column_ = compressed_[column_colouring_[column_]];
+        for (size_type row_ = 0; row_ < values_.size(); ++row_) {
+            std::set< size_type > const & nonzeros_ = sparsity_pattern_[row_];
+            if (nonzeros_.find(column_) == std::end(nonzeros_)) {
+                results_.push_back(ast::constant::zero); // structural zero
+            } else {
+                results_.push_back(compressed_column_[row_]);
+            }
+        }
+    }
+    ast::entry_definition entry_;
+    entry_.entry_name_.symbol_ = std::move(_name);
+    entry_.argument_list_ = _function.argument_list_;
+    entry_.body_.statements_ = std::move(accumulation_.statements_);
+    if (_output_limit < results_.size()) { // spill the rest into the caller-provided global variables
+        if (_output_limit == 0) {
+            throw std::runtime_error("at least one value should be returned");
+        }
+        ast::lvalues lvalues_;
+        ast::rvalues rvalues_;
+        for (ast::symbol const & spill_ : _spill) {
+            if (!(_output_limit + lvalues_.size() < results_.size())) {
+                break;
+            }
+            ast::identifier identifier_;
+            identifier_.symbol_ = spill_;
+            lvalues_.push_back(std::move(identifier_));
+            rvalues_.push_back(std::move(results_[_output_limit + rvalues_.size()]));
+        }
+        if (_output_limit + lvalues_.size() < results_.size()) {
+            throw std::runtime_error("not enough global variables to spill the Jacobian into");
+        }
+        results_.resize(_output_limit);
+        entry_.body_.statements_.push_back(ast::assignment{{std::move(lvalues_)}, ast::assign::assign, {std::move(rvalues_)}});
+    }
+    entry_.return_statement_.rvalues_ = std::move(results_);
+    return evaluate(eliminate_common_subexpressions(evaluate(std::move(entry_))));
+}
+
+ast::entry_definition
+Hessian_vector_product(ast::entry_definition const & _entry,
+                       ast::symbols const & _wrts,
+                       ast::symbols const & _direction,
+                       ast::symbol _name)
+{
+    ast::entry_definition const gradient_ = gradient(_entry, _wrts, _name);
+    accumulation accumulation_;
+    ast::rvalues values_ = accumulation_.linearize(gradient_); // forward over reverse
+    ast::lvalues arguments_ = gradient_.argument_list_.lvalues_;
+    std::map< ast::identifier, ast::operand > tangents_ = accumulation_.seed(_wrts, _direction, arguments_);
+    ast::rvalues products_ = accumulation_.forward_sweep(values_, std::move(tangents_));
+    ast::entry_definition entry_;
+    entry_.entry_name_.symbol_ = std::move(_name);
+    entry_.argument_list_.lvalues_ = std::move(arguments_);
+    entry_.body_.statements_ = std::move(accumulation_.statements_);
+    entry_.return_statement_.rvalues_ = std::move(values_);
+    products_.pop_front(); // directional derivative of the value itself is in the gradient already
+    for (ast::rvalue & product_ : products_) {
+        entry_.return_statement_.rvalues_.push_back(std::move(product_));
+    }
+    return evaluate(eliminate_common_subexpressions(evaluate(std::move(entry_))));
+}
+
+ast::entry_definition
+dual(ast::entry_definition const & _function,
+     ast::symbols const & _wrts,
+     std::deque< ast::symbols > const & _directions,
+     ast::symbol _name)
+{
+    accumulation accumulation_;
+    ast::rvalues values_ = accumulation_.linearize(_function);
+    ast::lvalues arguments_ = _function.argument_list_.lvalues_;
+    ast::rvalues results_ = values_;
+    for (ast::symbols const & direction_ : _directions) { // the tape is shared: only tangents are calculated for each direction
+        for (ast::rvalue & tangent_ : accumulation_.forward_sweep(values_, accumulation_.seed(_wrts, direction_, arguments_))) {
+            results_.push_back(std::move(tangent_));
+        }
+    }
+    ast::entry_definition entry_;
+    entry_.entry_name_.symbol_ = std::move(_name);
+    entry_.argument_list_.lvalues_ = std::move(arguments_);
+    entry_.body_.statements_ = std::move(accumulation_.statements_);
+    entry_.return_statement_.rvalues_ = std::move(results_);
+    return evaluate(eliminate_common_subexpressions(evaluate(std::move(entry_))));
+}
+
+}
+}
@@ -29,9 +29,17 @@ intrinsic_chs(ast::rvalues && /*_arguments*/, ast::rvalues && _darguments, ast::
 }
 
 bool
-intrinsic_abs(ast::rvalues && /*_arguments*/, ast::rvalues && /*_darguments*/, ast::rvalues & /*_results*/)
+intrinsic_abs(ast::rvalues && _arguments, ast::rvalues && _darguments, ast::rvalues & _results)
+{ // subgradient 0 at 0
+    _results.emplace_back(B{I{ast::intrinsic::sign, {std::move(_arguments)}}, ast::binary::mul, R{std::move(_darguments)}});
+    return true;
+}
+
+bool
+intrinsic_sign(ast::rvalues && /*_arguments*/, ast::rvalues && /*_darguments*/, ast::rvalues & _results)
 {
-    return false;
+    _results.emplace_back(ast::constant::zero);
+    return true;
 }
 
 bool
@@ -42,9 +50,25 @@ intrinsic_twice(ast::rvalues && /*_arguments*/, ast::rvalues && _darguments, ast
 }
 
 bool
-intrinsic_sumsqr(ast::rvalues && /*_arguments*/, ast::rvalues && /*_darguments*/, ast::rvalues & /*_results*/)
+intrinsic_sumsqr(ast::rvalues && _arguments, ast::rvalues && _darguments, ast::rvalues & _results)
 {
-    return false;
+    if (_arguments.size() != _darguments.size()) {
+        return false;
+    }
+    O sum_;
+    for (size_type i = 0; i < _arguments.size(); ++i) {
+        O term_ = B{std::move(_arguments[i]), ast::binary::mul, R{append< ast::rvalues >(std::move(_darguments[i]))}};
+        if (sum_.empty()) {
+            sum_ = std::move(term_);
+        } else {
+            sum_ = B{std::move(sum_), ast::binary::add, std::move(term_)};
+        }
+    }
+    if (sum_.empty()) {
+        return false;
+    }
+    _results.emplace_back(I{ast::intrinsic::twice, {append< ast::rvalues >(std::move(sum_))}});
+    return true;
 }
 
 bool
@@ -245,15 +269,67 @@ intrinsic_arccos(ast::rvalues && _arguments, ast::rvalues && _darguments, ast::r
 }
 
 bool
-intrinsic_max(ast::rvalues && /*_arguments*/, ast::rvalues && /*_darguments*/, ast::rvalues & /*_results*/)
+select_extremum(ast::intrinsic const _pick, ast::rvalues && _arguments, ast::rvalues && _darguments, ast::rvalues & _results)
+{ // branchless: derivative of the first extremal argument is picked by a chain of fcmov as cheap as the primal, ties give a valid subgradient
+    if (_arguments.size() != _darguments.size()) {
+        return false;
+    }
+    if (_arguments.empty()) {
+        return false;
+    }
+    if (_arguments.size() == 1) {
+        _results.push_back(std::move(_darguments.back()));
+        return true;
+    }
+    ast::rvalues pairs_;
+    for (size_type i = 0; i < _arguments.size(); ++i) {
+        pairs_.push_back(std::move(_arguments[i]));
+        pairs_.push_back(std::move(_darguments[i]));
+    }
+    _results.emplace_back(I{_pick, {std::move(pairs_)}});
+    return true;
+}
+
+bool
+select_derivative(ast::intrinsic const _pick, ast::rvalues && _arguments, ast::rvalues && _darguments, ast::rvalues & _results)
+{ // selection is piecewise constant: derivative of the picked value is picked
+    if (_arguments.size() != _darguments.size()) {
+        return false;
+    }
+    if (_arguments.empty() || ((_arguments.size() % 2) != 0)) {
+        return false;
+    }
+    ast::rvalues pairs_;
+    for (size_type i = 0; i < _arguments.size(); i += 2) {
+        pairs_.push_back(std::move(_arguments[i]));
+        pairs_.push_back(std::move(_darguments[i + 1]));
+    }
+    _results.emplace_back(I{_pick, {std::move(pairs_)}});
+    return true;
+}
+
+bool
+intrinsic_max(ast::rvalues && _arguments, ast::rvalues && _darguments, ast::rvalues & _results)
 {
-    return false;
+    return select_extremum(ast::intrinsic::pickmax, std::move(_arguments), std::move(_darguments), _results);
 }
 
 bool
-intrinsic_min(ast::rvalues && /*_arguments*/, ast::rvalues && /*_darguments*/, ast::rvalues & /*_results*/)
+intrinsic_min(ast::rvalues && _arguments, ast::rvalues && _darguments, ast::rvalues & _results)
 {
-    return false;
+    return select_extremum(ast::intrinsic::pickmin, std::move(_arguments), std::move(_darguments), _results);
+}
+
+bool
+intrinsic_pickmax(ast::rvalues && _arguments, ast::rvalues && _darguments, ast::rvalues & _results)
+{
+    return select_derivative(ast::intrinsic::pickmax, std::move(_arguments), std::move(_darguments), _results);
+}
+
+bool
+intrinsic_pickmin(ast::rvalues && _arguments, ast::rvalues && _darguments, ast::rvalues & _results)
+{
+    return select_derivative(ast::intrinsic::pickmin, std::move(_arguments), std::move(_darguments), _results);
 }
 
 bool
@@ -265,6 +341,7 @@ derive(ast::intrinsic const _intrinsic,
     switch (_intrinsic) {
     case ast::intrinsic::chs       : return intrinsic_chs      (std::move(_arguments), std::move(_darguments), _results);
     case ast::intrinsic::abs       : return intrinsic_abs      (std::move(_arguments), std::move(_darguments), _results);
+    case ast::intrinsic::sign      : return intrinsic_sign     (std::move(_arguments), std::move(_darguments), _results);
     case ast::intrinsic::twice     : return intrinsic_twice    (std::move(_arguments), std::move(_darguments), _results);
     case ast::intrinsic::sumsqr    : return intrinsic_sumsqr   (std::move(_arguments), std::move(_darguments), _results);
     case ast::intrinsic::sqrt      : return intrinsic_sqrt     (std::move(_arguments), std::move(_darguments), _results);
@@ -298,6 +375,8 @@ derive(ast::intrinsic const _intrinsic,
     case ast::intrinsic::arccos    : return intrinsic_arccos   (std::move(_arguments), std::move(_darguments), _results);
     case ast::intrinsic::max       : return intrinsic_max      (std::move(_arguments), std::move(_darguments), _results);
     case ast::intrinsic::min       : return intrinsic_min      (std::move(_arguments), std::move(_darguments), _results);
+    case ast::intrinsic::pickmax   : return intrinsic_pickmax  (std::move(_arguments), std::move(_darguments), _results);
+    case ast::intrinsic::pickmin   : return intrinsic_pickmin  (std::move(_arguments), std::move(_darguments), _results);
     }
 }
 
@@ -0,0 +1,376 @@
+#include <insituc/transform/derivator/sparsity.hpp>
+
+#include <insituc/utility/reverse.hpp>
+#include <insituc/utility/append.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <map>
+#include <set>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace transform
+{
+
+namespace
+{
+
+struct inputs
+{
+
+    std::set< size_type > arguments_;
+    std::set< ast::identifier > globals_;
+
+    void
+    merge(inputs const & _other)
+    {
+        arguments_.insert(std::cbegin(_other.arguments_), std::cend(_other.arguments_));
+        globals_.insert(std::cbegin(_other.globals_), std::cend(_other.globals_));
+    }
+
+};
+
+using values = std::deque< inputs >; // for each value of a list
+
+struct dependency_analysis
+{
+
+    ast::entries const * const entries_; // callees, if any
+    std::map< ast::symbol, values > & summaries_;
+    std::set< ast::symbol > & in_progress_;
+
+    std::deque< std::map< ast::identifier, inputs > > scopes_ = {}; // front is for the arguments and the assigned global variables
+
+    static
+    inputs
+    join(values const & _values)
+    {
+        inputs inputs_;
+        for (inputs const & value_ : _values) {
+            inputs_.merge(value_);
+        }
+        return inputs_;
+    }
+
+    inputs *
+    lookup(ast::identifier const & _identifier)
+    {
+        for (auto & scope_ : reverse(scopes_)) { // from inner scopes to outer
+            auto const binding_ = scope_.find(_identifier);
+            if (binding_ != std::end(scope_)) {
+                return &binding_->second;
+            }
+        }
+        return nullptr;
+    }
+
+    values const &
+    summary(ast::identifier const & _entry_name)
+    {
+        if (!_entry_name.is_original()) {
+            throw std::runtime_error("dependencies of the derivative " + _entry_name.symbol_.name_ + " are not known");
+        }
+        ast::symbol const & symbol_ = _entry_name.symbol_;
+        auto const summary_ = summaries_.find(symbol_);
+        if (summary_ != std::end(summaries_)) {
+            return summary_->second;
+        }
+        if (!entries_) {
+            throw std::runtime_error("entry substitution of " + symbol_.name_ + " is not allowed");
+        }
+        for (ast::entry_definition const & entry_ : reverse(*entries_)) {
+            if ((entry_.entry_name_.symbol_ == symbol_) && entry_.entry_name_.is_original()) {
+                if (!in_progress_.insert(symbol_).second) {
+                    throw std::runtime_error("recursive entry " + symbol_.name_);
+                }
+                values values_ = dependency_analysis{entries_, summaries_, in_progress_}(entry_);
+                in_progress_.erase(symbol_);
+                return summaries_.emplace(symbol_, std::move(values_)).first->second;
+            }
+        }
+        throw std::runtime_error("entry " + symbol_.name_ + " is not found");
+    }
+
+    [[noreturn]]
+    values
+    analyze_operand(ast::empty const & /*_empty*/)
+    {
+        throw std::runtime_error("empty expression is not allowed");
+    }
+
+    values
+    analyze_operand(G const & /*_value*/)
+    {
+        return values(1);
+    }
+
+    values
+    analyze_operand(ast::constant const /*_constant*/)
+    {
+        return values(1);
+    }
+
+    values
+    analyze_operand(ast::intrinsic_invocation const & _ast)
+    { // each result depends on all the arguments
+        return values(ast::result_count(_ast.intrinsic_), join(operator () (_ast.argument_list_.rvalues_)));
+    }
+
+    values
+    analyze_operand(ast::entry_substitution const & _ast)
+    {
+        values const arguments_ = operator () (_ast.argument_list_.rvalues_);
+        values results_;
+        for (inputs const & output_ : summary(_ast.entry_name_)) {
+            inputs result_;
+            result_.globals_ = output_.globals_;
+            for (size_type const argument_ : output_.arguments_) {
+                if (!(argument_ < arguments_.size())) {
+                    throw std::runtime_error("wrong number of arguments of " + _ast.entry_name_.symbol_.name_);
+                }
+                result_.merge(arguments_[argument_]);
+            }
+            results_.push_back(std::move(result_));
+        }
+        return results_;
+    }
+
+    values
+    analyze_operand(ast::identifier const & _identifier)
+    {
+        if (inputs const * const inputs_ = lookup(_identifier)) {
+            return append< values >(*inputs_);
+        }
+        inputs global_;
+        global_.globals_.insert(_identifier);
+        return append< values >(std::move(global_));
+    }
+
+    values
+    analyze_operand(ast::unary_expression const & _ast)
+    {
+        return operator () (_ast.operand_);
+    }
+
+    values
+    analyze_operand(ast::binary_expression const & _ast)
+    {
+        inputs inputs_ = join(operator () (_ast.lhs_));
+        inputs_.merge(join(operator () (_ast.rhs_)));
+        return append< values >(std::move(inputs_));
+    }
+
+    values
+    analyze_operand(ast::expression const & _expression)
+    {
+        if (_expression.rest_.empty()) {
+            return operator () (_expression.first_);
+        }
+        inputs inputs_ = join(operator () (_expression.first_));
+        for (ast::operation const & operation_ : _expression.rest_) {
+            inputs_.merge(join(operator () (operation_.operand_)));
+        }
+        return append< values >(std::move(inputs_));
+    }
+
+    values
+    analyze_operand(ast::rvalue_list const & _rvalue_list)
+    {
+        return operator () (_rvalue_list.rvalues_);
+    }
+
+    values
+    analyze_operand(ast::operand_cptr const _operand_cptr)
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    values
+    operator () (ast::operand const & _operand)
+    {
+        return visit([&] (auto const & o) -> values
+        {
+            return analyze_operand(o);
+        }, *_operand);
+    }
+
+    values
+    operator () (ast::rvalues const & _rvalues)
+    {
+        values values_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            for (inputs & inputs_ : operator () (rvalue_)) {
+                values_.push_back(std::move(inputs_));
+            }
+        }
+        return values_;
+    }
+
+    void
+    analyze_statement(ast::empty const & /*_empty*/)
+    {
+
+    }
+
+    void
+    analyze_statement(ast::variable_declaration const & _ast)
+    {
+        values values_ = operator () (_ast.rhs_.rvalues_);
+        if (values_.size() != _ast.lhs_.lvalues_.size()) {
+            throw std::runtime_error("number of values does not match number of variables");
+        }
+        auto value_ = std::begin(values_);
+        for (ast::lvalue const & lvalue_ : _ast.lhs_.lvalues_) {
+            scopes_.back()[lvalue_] = std::move(*value_++);
+        }
+    }
+
+    void
+    analyze_statement(ast::assignment const & _assignment)
+    {
+        values values_ = operator () (_assignment.rhs_.rvalues_);
+        if (values_.size() != _assignment.lhs_.lvalues_.size()) {
+            throw std::runtime_error("number of values does not match number of variables");
+        }
+        auto value_ = std::begin(values_);
+        for (ast::lvalue const & lvalue_ : _assignment.lhs_.lvalues_) {
+            inputs * const inputs_ = lookup(lvalue_);
+            if (!inputs_) { // global variable
+                scopes_.front()[lvalue_] = std::move(*value_);
+            } else if (_assignment.operator_ == ast::assign::assign) {
+                *inputs_ = std::move(*value_);
+            } else {
+                inputs_->merge(*value_);
+            }
+            ++value_;
+        }
+    }
+
+    void
+    analyze_statement(ast::statement_block const & _statement_block)
+    {
+        scopes_.emplace_back();
+        operator () (_statement_block.statements_);
+        scopes_.pop_back();
+    }
+
+    void
+    operator () (ast::statements const & _statements)
+    {
+        for (ast::statement const & statement_ : _statements) {
+            visit([&] (auto const & s) { analyze_statement(s); }, *statement_);
+        }
+    }
+
+    values
+    operator () (ast::entry_definition const & _entry)
+    {
+        assert(scopes_.empty());
+        scopes_.emplace_back();
+        size_type position_ = 0;
+        for (ast::lvalue const & argument_ : _entry.argument_list_.lvalues_) {
+            scopes_.back()[argument_].arguments_.insert(position_++);
+        }
+        operator () (_entry.body_.statements_);
+        values values_ = operator () (_entry.return_statement_.rvalues_);
+        scopes_.clear();
+        return values_;
+    }
+
+};
+
+sparsity_pattern
+get_sparsity_pattern(ast::entry_definition const & _entry,
+                     values const & _values,
+                     ast::symbols const & _wrts)
+{
+    sparsity_pattern sparsity_pattern_;
+    ast::lvalues const & arguments_ = _entry.argument_list_.lvalues_;
+    for (inputs const & value_ : _values) {
+        std::set< size_type > columns_;
+        size_type column_ = 0;
+        for (ast::symbol const & wrt_ : _wrts) {
+            ast::identifier identifier_;
+            identifier_.symbol_ = wrt_;
+            auto const argument_ = std::find(std::cbegin(arguments_), std::cend(arguments_), identifier_);
+            if (argument_ == std::cend(arguments_)) {
+                if (value_.globals_.find(identifier_) != std::end(value_.globals_)) {
+                    columns_.insert(column_);
+                }
+            } else if (value_.arguments_.find(static_cast< size_type >(std::distance(std::cbegin(arguments_), argument_))) != std::end(value_.arguments_)) {
+                columns_.insert(column_);
+            }
+            ++column_;
+        }
+        sparsity_pattern_.push_back(std::move(columns_));
+    }
+    return sparsity_pattern_;
+}
+
+}
+
+sparsity_pattern
+get_sparsity_pattern(ast::program const & _program,
+                     ast::symbol const & _target,
+                     ast::symbols const & _wrts)
+{
+    std::map< ast::symbol, values > summaries_;
+    std::set< ast::symbol > in_progress_;
+    for (ast::entry_definition const & entry_ : reverse(_program.entries_)) {
+        if ((entry_.entry_name_.symbol_ == _target) && entry_.entry_name_.is_original()) {
+            in_progress_.insert(_target);
+            return get_sparsity_pattern(entry_, dependency_analysis{&_program.entries_, summaries_, in_progress_}(entry_), _wrts);
+        }
+    }
+    throw std::runtime_error("entry " + _target.name_ + " is not found");
+}
+
+sparsity_pattern
+get_sparsity_pattern(ast::entry_definition const & _entry,
+                     ast::symbols const & _wrts)
+{
+    std::map< ast::symbol, values > summaries_;
+    std::set< ast::symbol > in_progress_;
+    return get_sparsity_pattern(_entry, dependency_analysis{nullptr, summaries_, in_progress_}(_entry), _wrts);
+}
+
+column_colouring
+colour_columns(sparsity_pattern const & _sparsity_pattern,
+               size_type const _column_count)
+{
+    std::vector< std::set< size_type > > neighbours_(_column_count); // column intersection graph
+    for (std::set< size_type > const & row_ : _sparsity_pattern) {
+        for (size_type const column_ : row_) {
+            assert(column_ < _column_count);
+            neighbours_[column_].insert(std::cbegin(row_), std::cend(row_));
+        }
+    }
+    size_type const uncoloured_ = _column_count;
+    column_colouring column_colouring_(_column_count, uncoloured_);
+    for (size_type column_ = 0; column_ < _column_count; ++column_) {
+        std::set< size_type > used_;
+        for (size_type const neighbour_ : neighbours_[column_]) {
+            if (column_colouring_[neighbour_] != uncoloured_) {
+                used_.insert(column_colouring_[neighbour_]);
+            }
+        }
+        size_type colour_ = 0;
+        while (used_.find(colour_) != std::end(used_)) {
+            ++colour_;
+        }
+        column_colouring_[column_] = colour_;
+    }
+    return column_colouring_;
+}
+
+}
+}
@@ -3,6 +3,10 @@
 #include <insituc/transform/evaluator/expression.hpp>
 #include <insituc/transform/evaluator/statement.hpp>
 
+#include <insituc/utility/parallel_for.hpp>
+
+#include <vector>
+
 namespace insituc
 {
 namespace transform
@@ -11,7 +15,7 @@ namespace transform
 ast::entry_definition
 evaluate(ast::entry_definition const & _entry)
 {
-    return {_entry.entry_name_, _entry.argument_list_, {transform::evaluate(_entry.body_.statements_)}, {{transform::evaluate(_entry.return_statement_.rvalues_)}}};
+    return {_entry.entry_name_, _entry.argument_list_, {transform::evaluate(_entry.body_.statements_)}, {transform::evaluate(_entry.return_statement_.rvalues_), _entry.return_statement_.pragma_}};
 }
 
 ast::entry_definition
@@ -41,5 +45,38 @@ evaluate(ast::program && _program)
     return std::move(_program);
 }
 
+ast::program
+evaluate_parallel(ast::program const & _program, size_type _concurrency)
+{
+    std::vector< ast::entry_definition const * > entries_;
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        entries_.push_back(&entry_);
+    }
+    std::vector< ast::entry_definition > results_(entries_.size());
+    parallel_for(entries_.size(), _concurrency, [&] (size_type const i)
+    {
+        results_[i] = evaluate(*entries_[i]);
+    });
+    ast::program program_;
+    for (ast::entry_definition & result_ : results_) {
+        program_.entries_.push_back(std::move(result_));
+    }
+    return program_;
+}
+
+ast::program
+evaluate_parallel(ast::program && _program, size_type _concurrency)
+{
+    std::vector< ast::entry_definition * > entries_;
+    for (ast::entry_definition & entry_ : _program.entries_) {
+        entries_.push_back(&entry_);
+    }
+    parallel_for(entries_.size(), _concurrency, [&] (size_type const i)
+    {
+        *entries_[i] = evaluate(std::move(*entries_[i]));
+    });
+    return std::move(_program);
+}
+
 }
 }
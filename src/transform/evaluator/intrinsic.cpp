@@ -118,6 +118,47 @@ intrinsic_abs(ast::rvalues && _arguments)
     return std::move(_arguments);
 }
 
+result_type
+intrinsic_sign(ast::rvalues && _arguments)
+{
+    if (_arguments.size() == 1) {
+        O & argument_ = _arguments.back();
+        switch (argument_.which()) {
+        case ast::index_at< O, G > : { // sign(r) = -1, 0 or 1
+            G const value_ = get< G && >(argument_);
+            if (zero < value_) {
+                argument_ = one;
+            } else if (value_ < zero) {
+                argument_ = -one;
+            } else if (value_ == zero) {
+                argument_ = zero;
+            } // NaN remains NaN
+            return std::move(_arguments);
+        }
+        case ast::index_at< O, I > : {
+            auto & intrinsic_invocation_ = get< I & >(argument_);
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wswitch-enum"
+            switch (intrinsic_invocation_.intrinsic_) {
+#pragma clang diagnostic pop
+            case ast::intrinsic::sign : { // sign(sign(x)) -> sign(x)
+                return std::move(_arguments);
+            }
+            default : {
+                break;
+            }
+            }
+            break;
+        }
+        default : {
+            break;
+        }
+        }
+    }
+    _arguments.emplace_back(I{ast::intrinsic::sign, {std::move(_arguments)}});
+    return std::move(_arguments);
+}
+
 result_type
 intrinsic_twice(ast::rvalues && _arguments)
 {
@@ -1460,12 +1501,42 @@ intrinsic_min(ast::rvalues && _arguments)
     return results_;
 }
 
+result_type
+pick_extremum(ast::intrinsic const _intrinsic, ast::rvalues && _arguments)
+{ // pick(a_1, b_1, ..., a_n, b_n) for literal a_i -> b_i
+    size_type const size_ = _arguments.size();
+    if ((0 < size_) && ((size_ % 2) == 0)) {
+        G const * extremum_ = nullptr;
+        size_type picked_ = 0;
+        for (size_type i = 0; i < size_; i += 2) {
+            G const * const value_ = get< G >(&_arguments[i]);
+            if (!value_) {
+                extremum_ = nullptr;
+                break;
+            }
+            if (!extremum_ || ((_intrinsic == ast::intrinsic::pickmax) ? (*extremum_ < *value_) : (*value_ < *extremum_))) {
+                extremum_ = value_;
+                picked_ = i + 1;
+            }
+        }
+        if (extremum_) {
+            result_type results_;
+            results_.push_back(std::move(_arguments[picked_]));
+            return results_;
+        }
+    }
+    result_type results_;
+    results_.emplace_back(I{_intrinsic, R{std::move(_arguments)}});
+    return results_;
+}
+
 result_type
 evaluate(ast::intrinsic const _intrinsic, ast::rvalues && _arguments)
 {
     switch (_intrinsic) {
     case ast::intrinsic::chs       : return intrinsic_chs      (std::move(_arguments));
     case ast::intrinsic::abs       : return intrinsic_abs      (std::move(_arguments));
+    case ast::intrinsic::sign      : return intrinsic_sign     (std::move(_arguments));
     case ast::intrinsic::twice     : return intrinsic_twice    (std::move(_arguments));
     case ast::intrinsic::sumsqr    : return intrinsic_sumsqr   (std::move(_arguments));
     case ast::intrinsic::sqrt      : return intrinsic_sqrt     (std::move(_arguments));
@@ -1499,6 +1570,8 @@ evaluate(ast::intrinsic const _intrinsic, ast::rvalues && _arguments)
     case ast::intrinsic::arccos    : return intrinsic_arccos   (std::move(_arguments));
     case ast::intrinsic::max       : return intrinsic_max      (std::move(_arguments));
     case ast::intrinsic::min       : return intrinsic_min      (std::move(_arguments));
+    case ast::intrinsic::pickmax   : return pick_extremum(_intrinsic, std::move(_arguments));
+    case ast::intrinsic::pickmin   : return pick_extremum(_intrinsic, std::move(_arguments));
     }
 }
 
@@ -0,0 +1,248 @@
+#include <insituc/transform/evaluator/precedence.hpp>
+
+#include <insituc/shunting_yard_algorithm.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <utility>
+#include <stdexcept>
+
+namespace insituc
+{
+namespace transform
+{
+
+namespace
+{
+
+using B = ast::binary_expression;
+using U = ast::unary_expression;
+using I = ast::intrinsic_invocation;
+using R = ast::rvalue_list;
+using O = ast::operand;
+
+struct precedence_resolution;
+
+struct tree_switch
+{
+
+    using result_type = O;
+
+    using rpn = shunting_yard_algorithm< tree_switch const, false >;
+    using node_type = typename rpn::node_type;
+
+    explicit
+    tree_switch(precedence_resolution const & _precedence_resolution)
+        : precedence_resolution_(_precedence_resolution)
+        , rpn_(*this)
+    { ; }
+
+    result_type
+    traverse(ast::expression const & _expression)
+    {
+        return rpn_.traverse(_expression);
+    }
+
+    result_type
+    operator () (O const & _operand) const;
+
+    result_type
+    operator () (O const & _lhs,
+                 ast::binary const _operator,
+                 O const & _rhs) const
+    {
+        return B{operator () (_lhs), _operator, operator () (_rhs)};
+    }
+
+    result_type
+    operator () (node_type const & _lhs,
+                 ast::binary const _operator,
+                 node_type const & _rhs) const
+    {
+        return B{rpn_(_lhs), _operator, rpn_(_rhs)};
+    }
+
+private :
+
+    precedence_resolution const & precedence_resolution_;
+    rpn rpn_;
+
+};
+
+struct precedence_resolution
+{
+
+    [[noreturn]]
+    O
+    resolve_operand(ast::empty const & /*_empty*/) const
+    {
+        throw std::runtime_error("empty operand in expression is not allowed");
+    }
+
+    O
+    resolve_operand(G const & _value) const
+    {
+        return _value;
+    }
+
+    O
+    resolve_operand(ast::constant const _constant) const
+    {
+        return _constant;
+    }
+
+    O
+    resolve_operand(I const & _ast) const
+    {
+        return I{_ast.intrinsic_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}};
+    }
+
+    O
+    resolve_operand(ast::entry_substitution const & _ast) const
+    {
+        return ast::entry_substitution{_ast.entry_name_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}};
+    }
+
+    O
+    resolve_operand(ast::identifier const & _identifier) const
+    {
+        return _identifier;
+    }
+
+    O
+    resolve_operand(U const & _ast) const
+    {
+        return U{_ast.operator_, operator () (_ast.operand_)};
+    }
+
+    O
+    resolve_operand(B const & _ast) const
+    {
+        return B{operator () (_ast.lhs_), _ast.operator_, operator () (_ast.rhs_)};
+    }
+
+    O
+    resolve_operand(ast::expression const & _expression) const
+    {
+        if (_expression.rest_.empty()) {
+            return operator () (_expression.first_);
+        }
+        tree_switch Dijkstra{*this};
+        return Dijkstra.traverse(_expression); // RPN
+    }
+
+    O
+    resolve_operand(R const & _rvalue_list) const
+    {
+        return R{operator () (_rvalue_list.rvalues_), _rvalue_list.pragma_};
+    }
+
+    O
+    resolve_operand(ast::operand_cptr const _operand_cptr) const
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    O
+    operator () (O const & _operand) const
+    {
+        return visit([&] (auto const & o) -> O
+        {
+            return resolve_operand(o);
+        }, *_operand);
+    }
+
+    ast::rvalues
+    operator () (ast::rvalues const & _rvalues) const
+    {
+        ast::rvalues rvalues_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            rvalues_.push_back(operator () (rvalue_));
+        }
+        return rvalues_;
+    }
+
+    ast::statement
+    resolve_statement(ast::empty const & _empty) const
+    {
+        return _empty;
+    }
+
+    ast::statement
+    resolve_statement(ast::variable_declaration const & _ast) const
+    {
+        return ast::variable_declaration{_ast.lhs_, {operator () (_ast.rhs_.rvalues_), _ast.rhs_.pragma_}};
+    }
+
+    ast::statement
+    resolve_statement(ast::assignment const & _assignment) const
+    {
+        return ast::assignment{_assignment.lhs_, _assignment.operator_, {operator () (_assignment.rhs_.rvalues_), _assignment.rhs_.pragma_}};
+    }
+
+    ast::statement
+    resolve_statement(ast::statement_block const & _statement_block) const
+    {
+        return ast::statement_block{operator () (_statement_block.statements_)};
+    }
+
+    ast::statement
+    operator () (ast::statement const & _statement) const
+    {
+        return visit([&] (auto const & s) -> ast::statement
+        {
+            return resolve_statement(s);
+        }, *_statement);
+    }
+
+    ast::statements
+    operator () (ast::statements const & _statements) const
+    {
+        ast::statements statements_;
+        for (ast::statement const & statement_ : _statements) {
+            statements_.push_back(operator () (statement_));
+        }
+        return statements_;
+    }
+
+    ast::entry_definition
+    operator () (ast::entry_definition const & _entry) const
+    {
+        return {_entry.entry_name_, _entry.argument_list_, {operator () (_entry.body_.statements_)}, {operator () (_entry.return_statement_.rvalues_), _entry.return_statement_.pragma_}};
+    }
+
+};
+
+auto
+tree_switch::operator () (O const & _operand) const
+-> result_type
+{
+    return precedence_resolution_(_operand);
+}
+
+}
+
+ast::operand
+resolve_precedence(ast::expression const & _expression)
+{
+    return precedence_resolution{}.resolve_operand(_expression);
+}
+
+ast::entry_definition
+resolve_precedence(ast::entry_definition const & _entry)
+{
+    return precedence_resolution{}(_entry);
+}
+
+ast::program
+resolve_precedence(ast::program const & _program)
+{
+    ast::program program_;
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        program_.append(resolve_precedence(entry_));
+    }
+    return program_;
+}
+
+}
+}
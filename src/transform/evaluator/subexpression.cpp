@@ -1,6 +1,7 @@
 #include <insituc/transform/evaluator/subexpression.hpp>
 
 #include <insituc/floating_point_type.hpp>
+#include <insituc/utility/numeric/exact_reciprocal.hpp>
 
 #include <versatile/visit.hpp>
 
@@ -245,8 +246,10 @@ evaluate(lhs && _lhs,
             return unary::evaluate(std::forward< lhs >(_lhs));
         } else if (_rhs == zero) {
             throw std::runtime_error("/ division by zero");
+        } else if (has_exact_reciprocal(_rhs)) {
+            return B{std::forward< lhs >(_lhs), ast::binary::mul, one / _rhs};
         }
-        return B{std::forward< lhs >(_lhs), ast::binary::mul, one / _rhs};
+        break;
     }
     case ast::binary::mod : {
         if (_rhs == zero) {
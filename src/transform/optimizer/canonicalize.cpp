@@ -0,0 +1,537 @@
+#include <insituc/transform/optimizer/canonicalize.hpp>
+
+#include <insituc/ast/compare.hpp>
+#include <insituc/floating_point_type.hpp>
+#include <insituc/utility/append.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <deque>
+#include <utility>
+#include <stdexcept>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace transform
+{
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+namespace
+{
+
+using U = ast::unary_expression;
+using B = ast::binary_expression;
+using I = ast::intrinsic_invocation;
+using R = ast::rvalue_list;
+using O = ast::operand;
+
+constexpr size_type max_terms = 32; // bounds the quadratic search of like terms and equal factors
+
+G const *
+literal(O const & _operand)
+{
+    O const & operand_ = ast::unref(_operand);
+    if (auto const * const rvalue_list_ = get< R >(&operand_)) {
+        if (rvalue_list_->rvalues_.size() == 1) {
+            return literal(rvalue_list_->rvalues_.back());
+        }
+        return nullptr;
+    }
+    return get< G >(&operand_);
+}
+
+I const *
+unary_invocation(O const & _operand, ast::intrinsic const _intrinsic)
+{
+    if (auto const * const intrinsic_invocation_ = get< I >(&ast::unref(_operand))) {
+        if ((intrinsic_invocation_->intrinsic_ == _intrinsic) && (intrinsic_invocation_->argument_list_.rvalues_.size() == 1)) {
+            return intrinsic_invocation_;
+        }
+    }
+    return nullptr;
+}
+
+G
+raise(G const & _base, difference_type const _exponent)
+{ // _base to the power of |_exponent|
+    G power_ = one;
+    for (difference_type i = 0; i < _exponent; ++i) {
+        power_ = power_ * _base;
+    }
+    for (difference_type i = 0; _exponent < i; --i) {
+        power_ = power_ * _base;
+    }
+    return power_;
+}
+
+struct factor
+{
+
+    O base_;
+    difference_type exponent_;
+
+};
+
+struct monomial
+{ // coefficient * product of powers of factors
+
+    bool cancel_;
+    G coefficient_ = one;
+    std::deque< factor > factors_ = {};
+    size_type literals_ = 0; // including twice
+    size_type signs_ = 0;
+    bool reduced_ = false;
+    bool bounded_ = true;
+
+    void
+    multiply(O const & _operand, difference_type const _exponent)
+    {
+        O const & operand_ = ast::unref(_operand);
+        if (G const * const value_ = literal(operand_)) {
+            if ((0 < _exponent) || !(*value_ == zero)) {
+                ++literals_;
+                G const power_ = raise(*value_, _exponent);
+                coefficient_ = (0 < _exponent) ? (coefficient_ * power_) : (coefficient_ / power_);
+                return;
+            }
+        } else if (auto const * const unary_expression_ = get< U >(&operand_)) {
+            if (unary_expression_->operator_ == ast::unary::minus) {
+                if ((_exponent % 2) == 0) {
+                    reduced_ = true; // even power absorbs the sign
+                } else {
+                    ++signs_;
+                    coefficient_ = -coefficient_;
+                }
+            }
+            return multiply(unary_expression_->operand_, _exponent);
+        } else if (auto const * const binary_expression_ = get< B >(&operand_)) {
+            if (binary_expression_->operator_ == ast::binary::mul) {
+                multiply(binary_expression_->lhs_, _exponent);
+                return multiply(binary_expression_->rhs_, _exponent);
+            } else if (binary_expression_->operator_ == ast::binary::div) {
+                multiply(binary_expression_->lhs_, _exponent);
+                return multiply(binary_expression_->rhs_, -_exponent);
+            }
+        } else if (I const * const sqr_ = unary_invocation(operand_, ast::intrinsic::sqr)) {
+            return multiply(sqr_->argument_list_.rvalues_.back(), 2 * _exponent);
+        } else if (I const * const twice_ = unary_invocation(operand_, ast::intrinsic::twice)) {
+            ++literals_;
+            G const power_ = raise(G(2), _exponent);
+            coefficient_ = (0 < _exponent) ? (coefficient_ * power_) : (coefficient_ / power_);
+            return join(ast::unref(twice_->argument_list_.rvalues_.back()), _exponent); // argument is not flattened
+        }
+        join(operand_, _exponent);
+    }
+
+    void
+    join(O const & _operand, difference_type const _exponent)
+    {
+        if (max_terms < factors_.size()) {
+            bounded_ = false;
+        } else {
+            for (factor & factor_ : factors_) {
+                if (!cancel_ && ((factor_.exponent_ < 0) != (_exponent < 0))) {
+                    continue; // x / x is not 1 for zero, infinite and NaN x
+                }
+                if (factor_.base_ == _operand) {
+                    factor_.exponent_ += _exponent;
+                    reduced_ = true;
+                    return;
+                }
+            }
+        }
+        factors_.push_back({_operand, _exponent});
+    }
+
+    bool
+    is_reduced() const
+    {
+        if (!bounded_) {
+            return false;
+        }
+        if (reduced_ || (1 < literals_) || (1 < signs_)) {
+            return true;
+        }
+        return ((0 < literals_) && (0 < signs_)) || (coefficient_ == zero);
+    }
+
+    bool
+    is_like(monomial const & _other) const
+    { // equal up to the order of factors
+        if (factors_.size() != _other.factors_.size()) {
+            return false;
+        }
+        std::deque< bool > matched_(_other.factors_.size(), false);
+        for (factor const & factor_ : factors_) {
+            bool found_ = false;
+            for (size_type i = 0; i < _other.factors_.size(); ++i) {
+                factor const & other_ = _other.factors_[i];
+                if (!matched_[i] && (factor_.exponent_ == other_.exponent_) && (factor_.base_ == other_.base_)) {
+                    matched_[i] = found_ = true;
+                    break;
+                }
+            }
+            if (!found_) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static
+    O
+    power(O const & _base, difference_type const _exponent)
+    {
+        assert(0 < _exponent);
+        if (_exponent == 1) {
+            return _base;
+        } else if (_exponent == 2) {
+            return I{ast::intrinsic::sqr, {append< ast::rvalues >(_base)}};
+        } else {
+            return B{_base, ast::binary::pow, static_cast< G >(static_cast< F >(_exponent))};
+        }
+    }
+
+    O
+    rebuild(G const & _magnitude) const
+    { // |_magnitude| * factors
+        O numerator_;
+        O denominator_;
+        for (factor const & factor_ : factors_) {
+            if (factor_.exponent_ == 0) {
+                continue; // cancelled out
+            }
+            O & product_ = (0 < factor_.exponent_) ? numerator_ : denominator_;
+            O power_ = power(factor_.base_, (0 < factor_.exponent_) ? factor_.exponent_ : -factor_.exponent_);
+            if (product_.empty()) {
+                product_ = std::move(power_);
+            } else {
+                product_ = B{std::move(product_), ast::binary::mul, std::move(power_)};
+            }
+        }
+        if (numerator_.empty()) {
+            numerator_ = _magnitude;
+        } else if (!(_magnitude == one)) {
+            numerator_ = B{_magnitude, ast::binary::mul, std::move(numerator_)};
+        }
+        if (denominator_.empty()) {
+            return numerator_;
+        }
+        return B{std::move(numerator_), ast::binary::div, std::move(denominator_)};
+    }
+
+    O
+    rebuild() const
+    {
+        if (coefficient_ == zero) {
+            return zero;
+        }
+        O product_ = rebuild(abs(coefficient_));
+        if (coefficient_ < zero) {
+            return U{ast::unary::minus, std::move(product_)};
+        }
+        return product_;
+    }
+
+};
+
+struct term
+{
+
+    bool negative_;
+    O operand_; // as is, while not merged
+    monomial monomial_;
+    bool merged_;
+
+};
+
+struct sum
+{
+
+    bool cancel_;
+    std::deque< term > terms_ = {};
+    G constant_ = zero;
+    size_type literals_ = 0;
+    bool reduced_ = false;
+    bool bounded_ = true;
+
+    void
+    add(O const & _operand, bool const _negative)
+    {
+        O const & operand_ = ast::unref(_operand);
+        if (G const * const value_ = literal(operand_)) {
+            ++literals_;
+            constant_ = _negative ? (constant_ - *value_) : (constant_ + *value_);
+            return;
+        } else if (auto const * const unary_expression_ = get< U >(&operand_)) {
+            return add(unary_expression_->operand_, (_negative != (unary_expression_->operator_ == ast::unary::minus)));
+        } else if (auto const * const binary_expression_ = get< B >(&operand_)) {
+            if (binary_expression_->operator_ == ast::binary::add) {
+                add(binary_expression_->lhs_, _negative);
+                return add(binary_expression_->rhs_, _negative);
+            } else if (binary_expression_->operator_ == ast::binary::sub) {
+                add(binary_expression_->lhs_, _negative);
+                return add(binary_expression_->rhs_, !_negative);
+            }
+        }
+        monomial monomial_{cancel_};
+        monomial_.multiply(operand_, 1);
+        if (_negative) {
+            monomial_.coefficient_ = -monomial_.coefficient_;
+        }
+        if (!monomial_.bounded_ || (max_terms < terms_.size())) {
+            bounded_ = false;
+        } else {
+            for (term & term_ : terms_) {
+                if (!cancel_ && ((term_.monomial_.coefficient_ < zero) != (monomial_.coefficient_ < zero))) {
+                    continue; // x - x is not 0 for infinite and NaN x
+                }
+                if (term_.monomial_.is_like(monomial_)) {
+                    term_.monomial_.coefficient_ += monomial_.coefficient_;
+                    term_.merged_ = reduced_ = true;
+                    return;
+                }
+            }
+        }
+        terms_.push_back({_negative, operand_, std::move(monomial_), false});
+    }
+
+    bool
+    is_reduced() const
+    {
+        return bounded_ && (reduced_ || (1 < literals_));
+    }
+
+    O
+    rebuild() const
+    {
+        O sum_;
+        auto const append_term_ = [&] (O && _operand, bool const _negative)
+        {
+            if (sum_.empty()) {
+                if (_negative) {
+                    sum_ = U{ast::unary::minus, std::move(_operand)};
+                } else {
+                    sum_ = std::move(_operand);
+                }
+            } else {
+                sum_ = B{std::move(sum_), (_negative ? ast::binary::sub : ast::binary::add), std::move(_operand)};
+            }
+        };
+        for (term const & term_ : terms_) {
+            if (!term_.merged_) {
+                append_term_(O{term_.operand_}, term_.negative_);
+                continue;
+            }
+            G const & coefficient_ = term_.monomial_.coefficient_;
+            if (coefficient_ == zero) {
+                continue; // cancelled out
+            }
+            append_term_(term_.monomial_.rebuild(abs(coefficient_)), (coefficient_ < zero));
+        }
+        if (!(constant_ == zero)) {
+            append_term_(abs(constant_), (constant_ < zero));
+        }
+        if (sum_.empty()) {
+            return zero;
+        }
+        return sum_;
+    }
+
+};
+
+struct canonicalizer
+{
+
+    bool const cancel_;
+
+    [[noreturn]]
+    O
+    canonicalize_operand(ast::empty const & /*_empty*/) const
+    {
+        throw std::runtime_error("empty operand in expression is not allowed");
+    }
+
+    O
+    canonicalize_operand(G const & _value) const
+    {
+        return _value;
+    }
+
+    O
+    canonicalize_operand(ast::constant const _constant) const
+    {
+        return _constant;
+    }
+
+    O
+    canonicalize_operand(I const & _ast) const
+    {
+        return I{_ast.intrinsic_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}};
+    }
+
+    O
+    canonicalize_operand(ast::entry_substitution const & _ast) const
+    {
+        return ast::entry_substitution{_ast.entry_name_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}};
+    }
+
+    O
+    canonicalize_operand(ast::identifier const & _identifier) const
+    {
+        return _identifier;
+    }
+
+    O
+    canonicalize_operand(U const & _ast) const
+    {
+        return U{_ast.operator_, operator () (_ast.operand_)};
+    }
+
+    O
+    canonicalize_operand(B const & _ast) const
+    { // bottom-up: operands are canonical already
+        O expression_ = B{operator () (_ast.lhs_), _ast.operator_, operator () (_ast.rhs_)};
+        switch (_ast.operator_) {
+        case ast::binary::add :
+        case ast::binary::sub : {
+            sum sum_{cancel_};
+            sum_.add(expression_, false);
+            if (sum_.is_reduced()) {
+                return sum_.rebuild();
+            }
+            break;
+        }
+        case ast::binary::mul :
+        case ast::binary::div : {
+            monomial monomial_{cancel_};
+            monomial_.multiply(expression_, 1);
+            if (monomial_.is_reduced()) {
+                return monomial_.rebuild();
+            }
+            break;
+        }
+        case ast::binary::mod :
+        case ast::binary::pow : {
+            break;
+        }
+        }
+        return expression_;
+    }
+
+    O
+    canonicalize_operand(ast::expression const & _expression) const
+    { // precedence is not resolved yet, only operands are canonicalized
+        ast::operation_list rest_;
+        for (ast::operation const & operation_ : _expression.rest_) {
+            rest_.push_back({operation_.operator_, operator () (operation_.operand_)});
+        }
+        return ast::expression{operator () (_expression.first_), std::move(rest_)};
+    }
+
+    O
+    canonicalize_operand(R const & _rvalue_list) const
+    {
+        return R{operator () (_rvalue_list.rvalues_), _rvalue_list.pragma_};
+    }
+
+    O
+    canonicalize_operand(ast::operand_cptr const _operand_cptr) const
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    O
+    operator () (O const & _operand) const
+    {
+        return visit([&] (auto const & o) -> O
+        {
+            return canonicalize_operand(o);
+        }, *_operand);
+    }
+
+    ast::rvalues
+    operator () (ast::rvalues const & _rvalues) const
+    {
+        ast::rvalues rvalues_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            rvalues_.push_back(operator () (rvalue_));
+        }
+        return rvalues_;
+    }
+
+    ast::statement
+    canonicalize_statement(ast::empty const & _empty) const
+    {
+        return _empty;
+    }
+
+    ast::statement
+    canonicalize_statement(ast::variable_declaration const & _ast) const
+    {
+        return ast::variable_declaration{_ast.lhs_, {operator () (_ast.rhs_.rvalues_)}};
+    }
+
+    ast::statement
+    canonicalize_statement(ast::assignment const & _assignment) const
+    {
+        return ast::assignment{_assignment.lhs_, _assignment.operator_, {operator () (_assignment.rhs_.rvalues_)}};
+    }
+
+    ast::statement
+    canonicalize_statement(ast::statement_block const & _statement_block) const
+    {
+        return ast::statement_block{operator () (_statement_block.statements_)};
+    }
+
+    ast::statement
+    operator () (ast::statement const & _statement) const
+    {
+        return visit([&] (auto const & s) -> ast::statement
+        {
+            return canonicalize_statement(s);
+        }, *_statement);
+    }
+
+    ast::statements
+    operator () (ast::statements const & _statements) const
+    {
+        ast::statements statements_;
+        for (ast::statement const & statement_ : _statements) {
+            statements_.push_back(operator () (statement_));
+        }
+        return statements_;
+    }
+
+    ast::entry_definition
+    operator () (ast::entry_definition const & _entry) const
+    {
+        return {_entry.entry_name_, _entry.argument_list_, {operator () (_entry.body_.statements_)}, {operator () (_entry.return_statement_.rvalues_), _entry.return_statement_.pragma_}};
+    }
+
+};
+
+}
+#pragma clang diagnostic pop
+
+ast::entry_definition
+canonicalize(ast::entry_definition const & _entry, bool const _cancel)
+{
+    return canonicalizer{_cancel}(_entry);
+}
+
+ast::program
+canonicalize(ast::program const & _program, bool const _cancel)
+{
+    ast::program program_;
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        program_.append(canonicalize(entry_, _cancel));
+    }
+    return program_;
+}
+
+}
+}
@@ -0,0 +1,162 @@
+#include <insituc/transform/optimizer/cse.hpp>
+
+#include <insituc/transform/optimizer/hoisting.hpp>
+
+#include <experimental/optional>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <utility>
+#include <iterator>
+
+namespace insituc
+{
+namespace transform
+{
+
+namespace
+{
+
+bool
+is_candidate(ast::operand const & _operand)
+{
+    if (_operand.active< ast::binary_expression >()) {
+        return true;
+    }
+    if (auto const * const expression_ = get< ast::expression >(&_operand)) {
+        return !expression_->rest_.empty();
+    }
+    // entry substitutions are not candidates: number of its results is unknown here
+    return _operand.active< ast::intrinsic_invocation >();
+}
+
+size_type
+result_count(ast::operand const & _operand)
+{
+    if (auto const * const intrinsic_invocation_ = get< ast::intrinsic_invocation >(&_operand)) {
+        return ast::result_count(intrinsic_invocation_->intrinsic_);
+    }
+    return 1;
+}
+
+struct subexpression
+{
+
+    ast::operand replacement_;
+    std::set< ast::identifier > dependencies_;
+
+};
+
+using subexpressions = std::unordered_map< ast::operand_cptr, subexpression, operand_cptr_hash, operand_cptr_equal >;
+
+struct common_subexpressions
+    : hoisting< common_subexpressions, subexpressions >
+{
+
+    using counter = std::map< size_type, size_type >; // by block: occurrences within its statement list and nested blocks
+    using counters = std::unordered_map< ast::operand_cptr, std::map< size_type, counter >, operand_cptr_hash, operand_cptr_equal >; // by epoch
+
+    counters counters_;
+
+    // first pass: hash-consing of the candidates
+
+    bool
+    count_node(ast::operand const & _operand)
+    {
+        if (is_candidate(_operand)) {
+            counter & counter_ = counters_[&_operand][epoch(_operand)];
+            for (size_type const block_ : blocks_) {
+                ++counter_[block_];
+            }
+            if (1 < counter_[blocks_.front()]) {
+                return false; // subexpressions of a repeated one would be calculated only once too
+            }
+        }
+        return true;
+    }
+
+    // occurrences left in the scope of the current statement list (this one included), the second pass takes them in order
+    size_type
+    take_occurrence(ast::operand const & _operand)
+    {
+        auto const counter_ = counters_.find(&_operand);
+        if (counter_ == std::end(counters_)) {
+            return 0;
+        }
+        auto const epoch_counter_ = counter_->second.find(epoch(_operand));
+        if (epoch_counter_ == std::end(counter_->second)) {
+            return 0;
+        }
+        counter & occurrences_ = epoch_counter_->second;
+        size_type const left_ = occurrences_[blocks_.back()];
+        for (size_type const block_ : blocks_) {
+            size_type & count_ = occurrences_[block_];
+            if (0 < count_) {
+                --count_;
+            }
+        }
+        return left_;
+    }
+
+    // second pass: hoisting of the repeated candidates
+
+    ast::operand
+    hoist(ast::operand const & _operand)
+    {
+        ast::operand subexpression_ = rewrite(_operand);
+        size_type const result_count_ = result_count(_operand);
+        ast::lvalues lvalues_;
+        for (size_type i = 0; i < result_count_; ++i) {
+            lvalues_.push_back(make_hidden({"_cse"}).back());
+        }
+        ast::rvalues rvalues_ = hoisting::hoist(std::move(lvalues_), std::move(subexpression_));
+        ast::operand replacement_;
+        if (result_count_ == 1) {
+            replacement_ = std::move(rvalues_.back());
+        } else {
+            replacement_ = ast::rvalue_list{std::move(rvalues_)};
+        }
+        std::set< ast::identifier > dependencies_;
+        dependencies{dependencies_}(_operand);
+        available_.emplace(&_operand, subexpression{replacement_, std::move(dependencies_)});
+        return replacement_;
+    }
+
+    std::experimental::optional< ast::operand >
+    substitute(ast::operand const & _operand)
+    {
+        if (is_candidate(_operand)) {
+            size_type const left_ = take_occurrence(_operand);
+            auto const available_subexpression_ = available_.find(&_operand);
+            if (available_subexpression_ != std::end(available_)) {
+                return available_subexpression_->second.replacement_;
+            }
+            if (1 < left_) { // otherwise the hidden variable would go out of scope before the next occurrence
+                return hoist(_operand);
+            }
+        }
+        return {};
+    }
+
+};
+
+}
+
+ast::entry_definition
+eliminate_common_subexpressions(ast::entry_definition const & _entry)
+{
+    return common_subexpressions{}(_entry);
+}
+
+ast::program
+eliminate_common_subexpressions(ast::program const & _program)
+{
+    ast::program program_;
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        program_.append(eliminate_common_subexpressions(entry_));
+    }
+    return program_;
+}
+
+}
+}
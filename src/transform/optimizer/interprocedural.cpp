@@ -0,0 +1,628 @@
+#include <insituc/transform/optimizer/interprocedural.hpp>
+
+#include <insituc/transform/optimizer/specialize.hpp>
+#include <insituc/transform/evaluator/evaluator.hpp>
+#include <insituc/transform/evaluator/expression.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <experimental/optional>
+#include <map>
+#include <deque>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace transform
+{
+
+namespace
+{
+
+using U = ast::unary_expression;
+using B = ast::binary_expression;
+using I = ast::intrinsic_invocation;
+using R = ast::rvalue_list;
+using O = ast::operand;
+
+using values = std::deque< O >;
+
+// number of nodes of a single-valued operand built of literals and constants only, 0 otherwise
+struct closure
+{
+
+    size_type
+    size(ast::empty const & /*_empty*/) const
+    {
+        return 0;
+    }
+
+    size_type
+    size(G const & /*_value*/) const
+    {
+        return 1;
+    }
+
+    size_type
+    size(ast::constant const /*_constant*/) const
+    {
+        return 1;
+    }
+
+    size_type
+    size(ast::identifier const & /*_identifier*/) const
+    {
+        return 0;
+    }
+
+    size_type
+    size(ast::entry_substitution const & /*_ast*/) const
+    {
+        return 0;
+    }
+
+    size_type
+    size(I const & _ast) const
+    {
+        if (ast::result_count(_ast.intrinsic_) != 1) {
+            return 0;
+        }
+        return sum(_ast.argument_list_.rvalues_, 1);
+    }
+
+    size_type
+    size(U const & _ast) const
+    {
+        return combine(1, operator () (_ast.operand_));
+    }
+
+    size_type
+    size(B const & _ast) const
+    {
+        return combine(combine(1, operator () (_ast.lhs_)), operator () (_ast.rhs_));
+    }
+
+    size_type
+    size(ast::expression const & _expression) const
+    {
+        size_type size_ = operator () (_expression.first_);
+        for (ast::operation const & operation_ : _expression.rest_) {
+            size_ = combine(size_, operator () (operation_.operand_));
+        }
+        return size_;
+    }
+
+    size_type
+    size(R const & _rvalue_list) const
+    {
+        if (_rvalue_list.rvalues_.size() != 1) {
+            return 0;
+        }
+        return operator () (_rvalue_list.rvalues_.back());
+    }
+
+    size_type
+    size(ast::operand_cptr const _operand_cptr) const
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    static
+    size_type
+    combine(size_type const _lhs, size_type const _rhs)
+    {
+        if ((_lhs == 0) || (_rhs == 0)) {
+            return 0;
+        }
+        return _lhs + _rhs;
+    }
+
+    size_type
+    sum(ast::rvalues const & _rvalues, size_type _size) const
+    {
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            _size = combine(_size, operator () (rvalue_));
+        }
+        return _size;
+    }
+
+    size_type
+    operator () (O const & _operand) const
+    {
+        return visit([&] (auto const & o) -> size_type
+        {
+            return size(o);
+        }, *_operand);
+    }
+
+};
+
+struct folder;
+
+struct frame
+{
+
+    folder & folder_;
+    size_type const position_; // only entries defined before can be called
+    bool const outermost_;     // code of the caller (not executed): unknown identifiers are its variables
+    std::deque< std::map< ast::identifier, O > > scopes_ = {};
+
+    O *
+    lookup(ast::identifier const & _identifier)
+    {
+        for (auto scope_ = std::rbegin(scopes_); scope_ != std::rend(scopes_); ++scope_) {
+            auto const variable_ = scope_->find(_identifier);
+            if (variable_ != std::end(*scope_)) {
+                return &variable_->second;
+            }
+        }
+        return nullptr;
+    }
+
+    [[noreturn]]
+    O
+    substitute_operand(ast::empty const & /*_empty*/)
+    {
+        throw std::runtime_error("empty operand in expression is not allowed");
+    }
+
+    O
+    substitute_operand(G const & _value)
+    {
+        return _value;
+    }
+
+    O
+    substitute_operand(ast::constant const _constant)
+    {
+        return _constant;
+    }
+
+    O
+    substitute_operand(ast::identifier const & _identifier)
+    {
+        if (O const * const value_ = lookup(_identifier)) {
+            return *value_;
+        }
+        return _identifier;
+    }
+
+    O
+    substitute_operand(I const & _ast)
+    {
+        return I{_ast.intrinsic_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}};
+    }
+
+    O
+    substitute_operand(ast::entry_substitution const & _ast);
+
+    O
+    substitute_operand(U const & _ast)
+    {
+        return U{_ast.operator_, operator () (_ast.operand_)};
+    }
+
+    O
+    substitute_operand(B const & _ast)
+    {
+        return B{operator () (_ast.lhs_), _ast.operator_, operator () (_ast.rhs_)};
+    }
+
+    O
+    substitute_operand(ast::expression const & _expression)
+    {
+        ast::operation_list rest_;
+        for (ast::operation const & operation_ : _expression.rest_) {
+            rest_.push_back({operation_.operator_, operator () (operation_.operand_)});
+        }
+        return ast::expression{operator () (_expression.first_), std::move(rest_)};
+    }
+
+    O
+    substitute_operand(R const & _rvalue_list)
+    {
+        return R{operator () (_rvalue_list.rvalues_), _rvalue_list.pragma_};
+    }
+
+    O
+    substitute_operand(ast::operand_cptr const _operand_cptr)
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    O
+    operator () (O const & _operand)
+    {
+        return visit([&] (auto const & o) -> O
+        {
+            return substitute_operand(o);
+        }, *_operand);
+    }
+
+    ast::rvalues
+    operator () (ast::rvalues const & _rvalues)
+    {
+        ast::rvalues rvalues_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            rvalues_.push_back(operator () (rvalue_));
+        }
+        return rvalues_;
+    }
+
+    std::experimental::optional< values >
+    values_of(ast::rvalues const & _rvalues);
+
+    bool
+    execute(ast::empty const & /*_empty*/)
+    {
+        return true;
+    }
+
+    bool
+    execute(ast::variable_declaration const & _ast)
+    {
+        auto values_ = values_of(_ast.rhs_.rvalues_);
+        if (!values_ || (values_->size() != _ast.lhs_.lvalues_.size())) {
+            return false;
+        }
+        auto value_ = std::begin(*values_);
+        for (ast::lvalue const & lvalue_ : _ast.lhs_.lvalues_) {
+            if (!lvalue_.is_dummy_placeholder()) {
+                scopes_.back()[lvalue_] = std::move(*value_);
+            }
+            ++value_;
+        }
+        return true;
+    }
+
+    bool
+    execute(ast::assignment const & _ast);
+
+    bool
+    execute(ast::statements const & _statements)
+    {
+        for (ast::statement const & statement_ : _statements) {
+            if (!visit([&] (auto const & s) -> bool { return execute(s); }, *statement_)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool
+    execute(ast::statement_block const & _ast)
+    {
+        scopes_.emplace_back();
+        if (!execute(_ast.statements_)) {
+            return false;
+        }
+        scopes_.pop_back();
+        return true;
+    }
+
+};
+
+// total order of literals of clone keys: unlike G::operator <, distinguishes -0 from 0 and NaN from other values
+struct literals_less
+{
+
+    bool
+    operator () (G const & _lhs, G const & _rhs) const
+    {
+        bool const lhs_nan_ = isnan(_lhs);
+        bool const rhs_nan_ = isnan(_rhs);
+        if (lhs_nan_ || rhs_nan_) {
+            if (lhs_nan_ != rhs_nan_) {
+                return rhs_nan_;
+            }
+        } else if (!(_lhs == _rhs)) {
+            return (_lhs < _rhs);
+        }
+        return (signbit(_lhs) && !signbit(_rhs));
+    }
+
+    bool
+    operator () (std::experimental::optional< G > const & _lhs, std::experimental::optional< G > const & _rhs) const
+    {
+        if (!_lhs || !_rhs) {
+            return (!_lhs && !!_rhs);
+        }
+        return operator () (*_lhs, *_rhs);
+    }
+
+    template< typename key >
+    bool
+    operator () (key const & _lhs, key const & _rhs) const
+    {
+        if (_lhs.first < _rhs.first) {
+            return true;
+        }
+        if (_rhs.first < _lhs.first) {
+            return false;
+        }
+        return std::lexicographical_compare(std::cbegin(_lhs.second), std::cend(_lhs.second),
+                                            std::cbegin(_rhs.second), std::cend(_rhs.second),
+                                            *this);
+    }
+
+};
+
+struct folder
+{
+
+    std::deque< ast::entry_definition const * > entries_;
+    std::map< ast::identifier, size_type > positions_;
+    size_type budget_;
+    bool const specialize_;
+    std::map< std::pair< ast::identifier, std::deque< std::experimental::optional< G > > >, ast::identifier, literals_less > clone_names_ = {};
+    ast::entries clones_ = {}; // pending, to be placed before the current entry
+
+    bool
+    charge(size_type const _cost)
+    {
+        if (budget_ < _cost) {
+            budget_ = 0;
+            return false;
+        }
+        budget_ -= _cost;
+        return true;
+    }
+
+    bool
+    expand(O const & _value, values & _values)
+    {
+        O const & value_ = ast::unref(_value);
+        if (auto const * const rvalue_list_ = get< R >(&value_)) {
+            for (ast::rvalue const & rvalue_ : rvalue_list_->rvalues_) {
+                if (!expand(rvalue_, _values)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        size_type const size_ = closure{}(value_);
+        if ((size_ == 0) || !charge(size_)) {
+            return false;
+        }
+        _values.push_back(value_);
+        return true;
+    }
+
+    std::experimental::optional< values >
+    expand(ast::rvalues const & _rvalues)
+    {
+        values values_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            if (!expand(rvalue_, values_)) {
+                return {};
+            }
+        }
+        return values_;
+    }
+
+    std::experimental::optional< values >
+    call(size_type const _position, values && _arguments)
+    {
+        if (!charge(1)) {
+            return {};
+        }
+        ast::entry_definition const & callee_ = *entries_.at(_position);
+        if (_arguments.size() != callee_.argument_list_.lvalues_.size()) {
+            return {};
+        }
+        frame frame_{*this, _position, false};
+        frame_.scopes_.emplace_back();
+        auto argument_ = std::begin(_arguments);
+        for (ast::lvalue const & parameter_ : callee_.argument_list_.lvalues_) {
+            frame_.scopes_.back()[parameter_] = std::move(*argument_++);
+        }
+        try {
+            if (!frame_.execute(callee_.body_.statements_)) { // locals of the body are visible in the return statement
+                return {};
+            }
+            return frame_.values_of(callee_.return_statement_.rvalues_);
+        } catch (std::runtime_error const & /*_exception*/) { // e.g. division by zero, the call is left to runtime
+            return {};
+        }
+    }
+
+    std::experimental::optional< ast::entry_substitution >
+    clone(size_type const _position, ast::rvalues const & _arguments)
+    {
+        ast::entry_definition const & callee_ = *entries_.at(_position);
+        ast::lvalues const & parameters_ = callee_.argument_list_.lvalues_;
+        if (_arguments.size() != parameters_.size()) {
+            return {};
+        }
+        frozen_variables frozen_variables_;
+        std::deque< std::experimental::optional< G > > literals_;
+        ast::lvalues rest_parameters_;
+        ast::rvalues rest_arguments_;
+        auto parameter_ = std::cbegin(parameters_);
+        for (ast::rvalue const & argument_ : _arguments) {
+            O const & operand_ = ast::unref(argument_);
+            if (G const * const literal_ = get< G >(&operand_)) {
+                frozen_variables_.emplace(*parameter_, *literal_);
+                literals_.push_back(*literal_);
+            } else {
+                if (operand_.active< R >() || operand_.active< ast::entry_substitution >()) {
+                    return {}; // number of values is not known
+                }
+                if (auto const * const intrinsic_invocation_ = get< I >(&operand_)) {
+                    if (ast::result_count(intrinsic_invocation_->intrinsic_) != 1) {
+                        return {};
+                    }
+                }
+                literals_.emplace_back();
+                rest_parameters_.push_back(*parameter_);
+                rest_arguments_.push_back(operand_);
+            }
+            ++parameter_;
+        }
+        if (frozen_variables_.empty()) {
+            return {};
+        }
+        auto const key_ = std::make_pair(callee_.entry_name_, std::move(literals_));
+        auto clone_name_ = clone_names_.find(key_);
+        if (clone_name_ == std::end(clone_names_)) {
+            ast::identifier name_ = callee_.entry_name_;
+            name_.symbol_.name_ += '#' + std::to_string(clone_names_.size());
+            ast::program clone_;
+            clone_.append(ast::entry_definition{name_, {std::move(rest_parameters_)}, callee_.body_, callee_.return_statement_});
+            try {
+                clone_ = specialize(clone_, frozen_variables_);
+            } catch (std::runtime_error const & /*_exception*/) { // parameter is assigned in the callee
+                return {};
+            }
+            clones_.push_back(fold(clone_.entries_.front(), _position));
+            clone_name_ = clone_names_.emplace(key_, std::move(name_)).first;
+        }
+        return ast::entry_substitution{clone_name_->second, {std::move(rest_arguments_)}};
+    }
+
+    O
+    fold_call(frame const & _frame, ast::entry_substitution && _call)
+    {
+        auto const position_ = positions_.find(_call.entry_name_);
+        if ((position_ == std::end(positions_)) || !(position_->second < _frame.position_)) {
+            return std::move(_call);
+        }
+        ast::rvalues const arguments_ = transform::evaluate(_call.argument_list_.rvalues_);
+        if (auto values_ = expand(arguments_)) {
+            if (auto results_ = call(position_->second, std::move(*values_))) {
+                if (results_->size() == 1) {
+                    return std::move(results_->back());
+                }
+                return R{ast::rvalues(std::make_move_iterator(std::begin(*results_)), std::make_move_iterator(std::end(*results_)))};
+            }
+        } else if (specialize_ && _frame.outermost_) {
+            if (auto clone_call_ = clone(position_->second, arguments_)) {
+                return std::move(*clone_call_);
+            }
+        }
+        return std::move(_call);
+    }
+
+    ast::statement
+    fold_statement(frame & /*_frame*/, ast::empty const & _empty)
+    {
+        return _empty;
+    }
+
+    ast::statement
+    fold_statement(frame & _frame, ast::variable_declaration const & _ast)
+    {
+        return ast::variable_declaration{_ast.lhs_, {_frame(_ast.rhs_.rvalues_), _ast.rhs_.pragma_}};
+    }
+
+    ast::statement
+    fold_statement(frame & _frame, ast::assignment const & _ast)
+    {
+        return ast::assignment{_ast.lhs_, _ast.operator_, {_frame(_ast.rhs_.rvalues_), _ast.rhs_.pragma_}};
+    }
+
+    ast::statement
+    fold_statement(frame & _frame, ast::statement_block const & _ast)
+    {
+        return ast::statement_block{fold(_frame, _ast.statements_)};
+    }
+
+    ast::statements
+    fold(frame & _frame, ast::statements const & _statements)
+    {
+        ast::statements statements_;
+        for (ast::statement const & statement_ : _statements) {
+            statements_.push_back(visit([&] (auto const & s) -> ast::statement
+            {
+                return fold_statement(_frame, s);
+            }, *statement_));
+        }
+        return statements_;
+    }
+
+    ast::entry_definition
+    fold(ast::entry_definition const & _entry, size_type const _position)
+    {
+        frame frame_{*this, _position, true};
+        ast::statements statements_ = fold(frame_, _entry.body_.statements_);
+        return {_entry.entry_name_, _entry.argument_list_, {std::move(statements_)}, {frame_(_entry.return_statement_.rvalues_), _entry.return_statement_.pragma_}};
+    }
+
+};
+
+O
+frame::substitute_operand(ast::entry_substitution const & _ast)
+{
+    return folder_.fold_call(*this, {_ast.entry_name_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}});
+}
+
+auto
+frame::values_of(ast::rvalues const & _rvalues)
+-> std::experimental::optional< values >
+{
+    if (!folder_.charge(1)) {
+        return {};
+    }
+    return folder_.expand(transform::evaluate(operator () (_rvalues)));
+}
+
+bool
+frame::execute(ast::assignment const & _ast)
+{
+    auto values_ = values_of(_ast.rhs_.rvalues_);
+    if (!values_ || (values_->size() != _ast.lhs_.lvalues_.size())) {
+        return false;
+    }
+    auto value_ = std::begin(*values_);
+    for (ast::lvalue const & lvalue_ : _ast.lhs_.lvalues_) {
+        if (!lvalue_.is_dummy_placeholder()) {
+            O * const variable_ = lookup(lvalue_);
+            if (!variable_) {
+                return false; // global variable
+            }
+            if (_ast.operator_ == ast::assign::assign) {
+                *variable_ = std::move(*value_);
+            } else {
+                values result_;
+                if (!folder_.expand(transform::evaluate(O{B{*variable_, ast::get_binary(_ast.operator_), std::move(*value_)}}), result_) || (result_.size() != 1)) {
+                    return false;
+                }
+                *variable_ = std::move(result_.back());
+            }
+        }
+        ++value_;
+    }
+    return true;
+}
+
+}
+
+ast::program
+fold_calls(ast::program const & _program,
+           size_type _budget,
+           bool const _specialize)
+{
+    folder folder_{{}, {}, _budget, _specialize};
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        if (folder_.positions_.emplace(entry_.entry_name_, folder_.entries_.size()).second) {
+            folder_.entries_.push_back(&entry_);
+        }
+    }
+    ast::program program_;
+    size_type position_ = 0;
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        ast::entry_definition folded_ = folder_.fold(entry_, position_++);
+        program_.entries_.splice(std::end(program_.entries_), folder_.clones_);
+        program_.append(std::move(folded_));
+    }
+    return evaluate(std::move(program_));
+}
+
+}
+}
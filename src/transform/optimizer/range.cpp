@@ -0,0 +1,697 @@
+#include <insituc/transform/optimizer/range.hpp>
+
+#include <insituc/floating_point_type.hpp>
+#include <insituc/utility/append.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <experimental/optional>
+
+#include <limits>
+#include <deque>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace transform
+{
+
+interval
+unbounded()
+{
+    G const infinity_ = G(std::numeric_limits< F >::infinity());
+    return {-infinity_, infinity_};
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+namespace
+{
+
+using U = ast::unary_expression;
+using B = ast::binary_expression;
+using I = ast::intrinsic_invocation;
+using R = ast::rvalue_list;
+using O = ast::operand;
+
+G
+minimum(G const & _lhs, G const & _rhs)
+{
+    return (_rhs < _lhs) ? _rhs : _lhs;
+}
+
+G
+maximum(G const & _lhs, G const & _rhs)
+{
+    return (_lhs < _rhs) ? _rhs : _lhs;
+}
+
+G
+product(G const & _lhs, G const & _rhs)
+{ // zero times infinity is zero for bounds
+    if ((_lhs == zero) || (_rhs == zero)) {
+        return zero;
+    }
+    return _lhs * _rhs;
+}
+
+G
+signum(G const & _value)
+{
+    if (zero < _value) {
+        return one;
+    } else if (_value < zero) {
+        return -one;
+    }
+    return zero;
+}
+
+bool
+contains_zero(interval const & _interval)
+{
+    return !(zero < _interval.lower_) && !(_interval.upper_ < zero);
+}
+
+interval
+negate(interval const & _interval)
+{
+    return {-_interval.upper_, -_interval.lower_};
+}
+
+interval
+add(interval const & _lhs, interval const & _rhs)
+{
+    return {_lhs.lower_ + _rhs.lower_, _lhs.upper_ + _rhs.upper_};
+}
+
+interval
+subtract(interval const & _lhs, interval const & _rhs)
+{
+    return {_lhs.lower_ - _rhs.upper_, _lhs.upper_ - _rhs.lower_};
+}
+
+interval
+multiply(interval const & _lhs, interval const & _rhs)
+{
+    G const ll_ = product(_lhs.lower_, _rhs.lower_);
+    G const lu_ = product(_lhs.lower_, _rhs.upper_);
+    G const ul_ = product(_lhs.upper_, _rhs.lower_);
+    G const uu_ = product(_lhs.upper_, _rhs.upper_);
+    return {minimum(minimum(ll_, lu_), minimum(ul_, uu_)), maximum(maximum(ll_, lu_), maximum(ul_, uu_))};
+}
+
+interval
+divide(interval const & _lhs, interval const & _rhs)
+{
+    if (contains_zero(_rhs)) {
+        return unbounded();
+    }
+    return multiply(_lhs, {one / _rhs.upper_, one / _rhs.lower_});
+}
+
+interval
+absolute(interval const & _interval)
+{
+    if (!(_interval.lower_ < zero)) {
+        return _interval;
+    } else if (!(zero < _interval.upper_)) {
+        return negate(_interval);
+    }
+    return {zero, maximum(-_interval.lower_, _interval.upper_)};
+}
+
+interval
+square(interval const & _interval)
+{
+    interval const absolute_ = absolute(_interval);
+    return {product(absolute_.lower_, absolute_.lower_), product(absolute_.upper_, absolute_.upper_)};
+}
+
+G
+constant_value(ast::constant const _constant)
+{
+    switch (_constant) {
+    case ast::constant::zero : return zero;
+    case ast::constant::one  : return one;
+    case ast::constant::pi   : return acos(-one);
+    case ast::constant::l2e  : return log2(exp(one));
+    case ast::constant::l2t  : return log2(G(10));
+    case ast::constant::lg2  : return log10(G(2));
+    case ast::constant::ln2  : return log(G(2));
+    }
+    throw std::runtime_error("unknown constant");
+}
+
+struct range_evaluator
+{
+
+    variable_ranges const & declared_ranges_;
+    std::deque< variable_ranges > const & scopes_; // innermost is the last
+
+    interval
+    range(ast::empty const & /*_empty*/) const
+    {
+        return unbounded();
+    }
+
+    interval
+    range(G const & _value) const
+    {
+        return {_value, _value};
+    }
+
+    interval
+    range(ast::constant const _constant) const
+    {
+        G const value_ = constant_value(_constant);
+        return {value_, value_};
+    }
+
+    interval
+    range(I const & _ast) const
+    {
+        ast::rvalues const & arguments_ = _ast.argument_list_.rvalues_;
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wswitch-enum"
+        switch (_ast.intrinsic_) { // codomains and variadic intrinsics
+#pragma clang diagnostic pop
+        case ast::intrinsic::sumsqr : {
+            interval sum_{zero, zero};
+            for (O const & argument_ : arguments_) {
+                sum_ = add(sum_, square(operator () (argument_)));
+            }
+            return sum_;
+        }
+        case ast::intrinsic::max :
+        case ast::intrinsic::min : {
+            if (arguments_.empty()) {
+                break;
+            }
+            interval extremum_ = operator () (arguments_.front());
+            for (auto argument_ = std::next(std::cbegin(arguments_)); argument_ != std::cend(arguments_); ++argument_) {
+                interval const range_ = operator () (*argument_);
+                if (_ast.intrinsic_ == ast::intrinsic::max) {
+                    extremum_ = {maximum(extremum_.lower_, range_.lower_), maximum(extremum_.upper_, range_.upper_)};
+                } else {
+                    extremum_ = {minimum(extremum_.lower_, range_.lower_), minimum(extremum_.upper_, range_.upper_)};
+                }
+            }
+            return extremum_;
+        }
+        case ast::intrinsic::cos :
+        case ast::intrinsic::sin :
+        case ast::intrinsic::frac : {
+            return {-one, one};
+        }
+        case ast::intrinsic::atan2 : {
+            G const pi_ = acos(-one);
+            return {-pi_, pi_};
+        }
+        case ast::intrinsic::arcsin : {
+            return {asin(-one), asin(one)};
+        }
+        case ast::intrinsic::arccos : {
+            return {zero, acos(-one)};
+        }
+        default : {
+            break;
+        }
+        }
+        if (arguments_.size() != 1) {
+            return unbounded();
+        }
+        interval const x_ = operator () (arguments_.back());
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wswitch-enum"
+        switch (_ast.intrinsic_) { // unary intrinsics, monotonic ones map bounds
+#pragma clang diagnostic pop
+        case ast::intrinsic::chs    : return negate(x_);
+        case ast::intrinsic::abs    : return absolute(x_);
+        case ast::intrinsic::sign   : return {signum(x_.lower_), signum(x_.upper_)};
+        case ast::intrinsic::twice  : return add(x_, x_);
+        case ast::intrinsic::sqr    : return square(x_);
+        case ast::intrinsic::round  : return {nearbyint(x_.lower_), nearbyint(x_.upper_)};
+        case ast::intrinsic::trunc  : return {trunc(x_.lower_), trunc(x_.upper_)};
+        case ast::intrinsic::arctg  : return {atan(x_.lower_), atan(x_.upper_)};
+        case ast::intrinsic::exp    : return {exp(x_.lower_), exp(x_.upper_)};
+        case ast::intrinsic::pow2   : return {exp2(x_.lower_), exp2(x_.upper_)};
+        case ast::intrinsic::pow2m1 : return {exp2(x_.lower_) - one, exp2(x_.upper_) - one};
+        case ast::intrinsic::sqrt : {
+            if (x_.upper_ < zero) {
+                break;
+            }
+            return {(x_.lower_ < zero) ? zero : sqrt(x_.lower_), sqrt(x_.upper_)};
+        }
+        case ast::intrinsic::ln : {
+            if (zero < x_.lower_) {
+                return {log(x_.lower_), log(x_.upper_)};
+            }
+            break;
+        }
+        case ast::intrinsic::log2 : {
+            if (zero < x_.lower_) {
+                return {log2(x_.lower_), log2(x_.upper_)};
+            }
+            break;
+        }
+        case ast::intrinsic::lg : {
+            if (zero < x_.lower_) {
+                return {log10(x_.lower_), log10(x_.upper_)};
+            }
+            break;
+        }
+        default : {
+            break;
+        }
+        }
+        return unbounded();
+    }
+
+    interval
+    range(ast::entry_substitution const & /*_ast*/) const
+    {
+        return unbounded();
+    }
+
+    interval
+    range(ast::identifier const & _identifier) const
+    {
+        for (auto scope_ = std::crbegin(scopes_); scope_ != std::crend(scopes_); ++scope_) {
+            auto const variable_ = scope_->find(_identifier);
+            if (variable_ != std::end(*scope_)) {
+                return variable_->second;
+            }
+        }
+        auto const declared_range_ = declared_ranges_.find(_identifier);
+        if (declared_range_ != std::end(declared_ranges_)) {
+            return declared_range_->second;
+        }
+        return unbounded();
+    }
+
+    interval
+    range(U const & _ast) const
+    {
+        interval const operand_ = operator () (_ast.operand_);
+        switch (_ast.operator_) {
+        case ast::unary::plus  : return operand_;
+        case ast::unary::minus : return negate(operand_);
+        }
+        throw std::runtime_error("unknown unary operator");
+    }
+
+    interval
+    range(B const & _ast) const
+    {
+        interval const lhs_ = operator () (_ast.lhs_);
+        interval const rhs_ = operator () (_ast.rhs_);
+        switch (_ast.operator_) {
+        case ast::binary::add : return add(lhs_, rhs_);
+        case ast::binary::sub : return subtract(lhs_, rhs_);
+        case ast::binary::mul : return multiply(lhs_, rhs_);
+        case ast::binary::div : return divide(lhs_, rhs_);
+        case ast::binary::mod : return unbounded();
+        case ast::binary::pow : return unbounded();
+        }
+        throw std::runtime_error("unknown binary operator");
+    }
+
+    interval
+    range(ast::expression const & /*_expression*/) const
+    { // precedence is not resolved yet
+        return unbounded();
+    }
+
+    interval
+    range(R const & _rvalue_list) const
+    {
+        if (_rvalue_list.rvalues_.size() == 1) {
+            return operator () (_rvalue_list.rvalues_.back());
+        }
+        return unbounded();
+    }
+
+    interval
+    range(ast::operand_cptr const _operand_cptr) const
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    interval
+    operator () (O const & _operand) const
+    {
+        return visit([&] (auto const & o) -> interval
+        {
+            return range(o);
+        }, *_operand);
+    }
+
+};
+
+G const *
+literal(O const & _operand)
+{
+    O const & operand_ = ast::unref(_operand);
+    if (auto const * const rvalue_list_ = get< R >(&operand_)) {
+        if (rvalue_list_->rvalues_.size() == 1) {
+            return literal(rvalue_list_->rvalues_.back());
+        }
+        return nullptr;
+    }
+    return get< G >(&operand_);
+}
+
+bool
+is_one(O const & _operand)
+{
+    if (G const * const value_ = literal(_operand)) {
+        return (*value_ == one);
+    }
+    if (auto const * const constant_ = get< ast::constant >(&ast::unref(_operand))) {
+        return (*constant_ == ast::constant::one);
+    }
+    return false;
+}
+
+O const *
+log1p_argument(O const & _operand) // x of 1 + x or x + 1
+{
+    if (auto const * const binary_expression_ = get< B >(&ast::unref(_operand))) {
+        if (binary_expression_->operator_ == ast::binary::add) {
+            if (is_one(binary_expression_->lhs_)) {
+                return &binary_expression_->rhs_;
+            } else if (is_one(binary_expression_->rhs_)) {
+                return &binary_expression_->lhs_;
+            }
+        }
+    }
+    return nullptr;
+}
+
+struct lowering
+{
+
+    variable_ranges const & declared_ranges_;
+    size_type const fast_math_;
+    std::deque< variable_ranges > scopes_ = {};
+
+    interval
+    range(O const & _operand) const
+    {
+        return range_evaluator{declared_ranges_, scopes_}(_operand);
+    }
+
+    std::deque< interval >
+    ranges(ast::rvalues const & _rvalues, size_type const _count) const
+    {
+        std::deque< interval > ranges_;
+        if (_rvalues.size() == _count) { // otherwise there are multivalued rvalues
+            for (O const & rvalue_ : _rvalues) {
+                ranges_.push_back(range(rvalue_));
+            }
+        } else {
+            ranges_.assign(_count, unbounded());
+        }
+        return ranges_;
+    }
+
+    std::experimental::optional< O >
+    lower_logarithm(O const & _argument, O && _multiplier) const
+    { // y * log2(1 + x) = yl2xp1(x, y), where y is ln2 for ln and lg2 for lg
+        if (fast_math_ < 2) {
+            return {};
+        }
+        if (O const * const x_ = log1p_argument(_argument)) {
+            G const bound_ = one - sqrt(G(2)) / G(2);
+            if (range(*x_).is_within(-bound_, bound_)) {
+                return O{I{ast::intrinsic::yl2xp1, {append< ast::rvalues >(O{*x_}, std::move(_multiplier))}}};
+            }
+        }
+        return {};
+    }
+
+    [[noreturn]]
+    O
+    lower_operand(ast::empty const & /*_empty*/) const
+    {
+        throw std::runtime_error("empty operand in expression is not allowed");
+    }
+
+    O
+    lower_operand(G const & _value) const
+    {
+        return _value;
+    }
+
+    O
+    lower_operand(ast::constant const _constant) const
+    {
+        return _constant;
+    }
+
+    O
+    lower_operand(I const & _ast) const
+    {
+        ast::rvalues arguments_ = operator () (_ast.argument_list_.rvalues_);
+        if ((arguments_.size() == 1) && (0 < fast_math_)) {
+            O & argument_ = arguments_.back();
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wswitch-enum"
+            switch (_ast.intrinsic_) {
+#pragma clang diagnostic pop
+            case ast::intrinsic::abs : {
+                interval const range_ = range(argument_);
+                if (!(range_.lower_ < zero)) {
+                    return std::move(argument_);
+                } else if (!(zero < range_.upper_)) {
+                    return U{ast::unary::minus, std::move(argument_)};
+                }
+                break;
+            }
+            case ast::intrinsic::ln : {
+                if (auto logarithm_ = lower_logarithm(argument_, ast::constant::ln2)) {
+                    return std::move(*logarithm_);
+                }
+                break;
+            }
+            case ast::intrinsic::log2 : {
+                if (auto logarithm_ = lower_logarithm(argument_, one)) {
+                    return std::move(*logarithm_);
+                }
+                break;
+            }
+            case ast::intrinsic::lg : {
+                if (auto logarithm_ = lower_logarithm(argument_, ast::constant::lg2)) {
+                    return std::move(*logarithm_);
+                }
+                break;
+            }
+            case ast::intrinsic::pow2 : { // 2^x = pow2m1(x) + 1 for |x| <= 1 avoids frndint and fscale
+                if ((1 < fast_math_) && range(argument_).is_within(-one, one)) {
+                    return B{I{ast::intrinsic::pow2m1, {std::move(arguments_)}}, ast::binary::add, one};
+                }
+                break;
+            }
+            case ast::intrinsic::exp : { // e^x = pow2m1(x * l2e) + 1, the margin covers rounding of the product
+                G const bound_ = G(0.5);
+                if ((1 < fast_math_) && range(argument_).is_within(-bound_, bound_)) {
+                    O exponent_ = B{ast::constant::l2e, ast::binary::mul, std::move(argument_)};
+                    return B{I{ast::intrinsic::pow2m1, {append< ast::rvalues >(std::move(exponent_))}}, ast::binary::add, one};
+                }
+                break;
+            }
+            default : {
+                break;
+            }
+            }
+        }
+        return I{_ast.intrinsic_, {std::move(arguments_), _ast.argument_list_.pragma_}};
+    }
+
+    O
+    lower_operand(ast::entry_substitution const & _ast) const
+    {
+        return ast::entry_substitution{_ast.entry_name_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}};
+    }
+
+    O
+    lower_operand(ast::identifier const & _identifier) const
+    {
+        return _identifier;
+    }
+
+    O
+    lower_operand(U const & _ast) const
+    {
+        return U{_ast.operator_, operator () (_ast.operand_)};
+    }
+
+    O
+    lower_operand(B const & _ast) const
+    {
+        return B{operator () (_ast.lhs_), _ast.operator_, operator () (_ast.rhs_)};
+    }
+
+    O
+    lower_operand(ast::expression const & _expression) const
+    {
+        ast::operation_list rest_;
+        for (ast::operation const & operation_ : _expression.rest_) {
+            rest_.push_back({operation_.operator_, operator () (operation_.operand_)});
+        }
+        return ast::expression{operator () (_expression.first_), std::move(rest_)};
+    }
+
+    O
+    lower_operand(R const & _rvalue_list) const
+    {
+        return R{operator () (_rvalue_list.rvalues_), _rvalue_list.pragma_};
+    }
+
+    O
+    lower_operand(ast::operand_cptr const _operand_cptr) const
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    O
+    operator () (O const & _operand) const
+    {
+        return visit([&] (auto const & o) -> O
+        {
+            return lower_operand(o);
+        }, *_operand);
+    }
+
+    ast::rvalues
+    operator () (ast::rvalues const & _rvalues) const
+    {
+        ast::rvalues rvalues_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            rvalues_.push_back(operator () (rvalue_));
+        }
+        return rvalues_;
+    }
+
+    ast::statement
+    lower_statement(ast::empty const & _empty)
+    {
+        return _empty;
+    }
+
+    ast::statement
+    lower_statement(ast::variable_declaration const & _ast)
+    {
+        assert(!scopes_.empty());
+        ast::rvalues rhs_ = operator () (_ast.rhs_.rvalues_);
+        std::deque< interval > const ranges_ = ranges(rhs_, _ast.lhs_.lvalues_.size());
+        auto range_ = std::cbegin(ranges_);
+        for (ast::lvalue const & lvalue_ : _ast.lhs_.lvalues_) {
+            scopes_.back().insert_or_assign(lvalue_, *range_);
+            ++range_;
+        }
+        return ast::variable_declaration{_ast.lhs_, {std::move(rhs_)}};
+    }
+
+    ast::statement
+    lower_statement(ast::assignment const & _assignment)
+    {
+        ast::lvalues const & lvalues_ = _assignment.lhs_.lvalues_;
+        ast::rvalues rhs_ = operator () (_assignment.rhs_.rvalues_);
+        std::deque< interval > ranges_;
+        if (_assignment.operator_ == ast::assign::assign) {
+            ranges_ = ranges(rhs_, lvalues_.size());
+        } else {
+            ranges_.assign(lvalues_.size(), unbounded());
+        }
+        auto range_ = std::cbegin(ranges_);
+        for (ast::lvalue const & lvalue_ : lvalues_) {
+            bool assigned_ = false;
+            for (auto scope_ = std::rbegin(scopes_); scope_ != std::rend(scopes_); ++scope_) {
+                auto const variable_ = scope_->find(lvalue_);
+                if (variable_ != std::end(*scope_)) {
+                    variable_->second = *range_;
+                    assigned_ = true;
+                    break;
+                }
+            }
+            if (!assigned_ && (declared_ranges_.find(lvalue_) != std::end(declared_ranges_))) {
+                throw std::runtime_error("global variable with declared range cannot be assigned");
+            }
+            ++range_;
+        }
+        return ast::assignment{_assignment.lhs_, _assignment.operator_, {std::move(rhs_)}};
+    }
+
+    ast::statement
+    lower_statement(ast::statement_block const & _statement_block)
+    {
+        scopes_.emplace_back();
+        ast::statements statements_ = operator () (_statement_block.statements_);
+        scopes_.pop_back();
+        return ast::statement_block{std::move(statements_)};
+    }
+
+    ast::statement
+    operator () (ast::statement const & _statement)
+    {
+        return visit([&] (auto const & s) -> ast::statement
+        {
+            return lower_statement(s);
+        }, *_statement);
+    }
+
+    ast::statements
+    operator () (ast::statements const & _statements)
+    {
+        ast::statements statements_;
+        for (ast::statement const & statement_ : _statements) {
+            statements_.push_back(operator () (statement_));
+        }
+        return statements_;
+    }
+
+    ast::entry_definition
+    operator () (ast::entry_definition const & _entry)
+    {
+        assert(scopes_.empty());
+        scopes_.emplace_back();
+        for (ast::lvalue const & argument_ : _entry.argument_list_.lvalues_) { // shadow declared ranges of globals
+            scopes_.back().insert_or_assign(argument_, unbounded());
+        }
+        ast::statements statements_ = operator () (_entry.body_.statements_);
+        ast::rvalues rvalues_ = operator () (_entry.return_statement_.rvalues_);
+        scopes_.pop_back();
+        return {_entry.entry_name_, _entry.argument_list_, {std::move(statements_)}, {std::move(rvalues_), _entry.return_statement_.pragma_}};
+    }
+
+};
+
+}
+#pragma clang diagnostic pop
+
+interval
+get_range(ast::operand const & _operand,
+          variable_ranges const & _variable_ranges)
+{
+    std::deque< variable_ranges > const scopes_;
+    return range_evaluator{_variable_ranges, scopes_}(_operand);
+}
+
+ast::program
+lower_intrinsics(ast::program const & _program,
+                 variable_ranges const & _declared_ranges)
+{
+    ast::program program_;
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        program_.append(lowering{_declared_ranges, entry_.return_statement_.pragma_.options_.fast_math_level()}(entry_));
+    }
+    return program_;
+}
+
+}
+}
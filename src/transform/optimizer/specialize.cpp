@@ -0,0 +1,225 @@
+#include <insituc/transform/optimizer/specialize.hpp>
+
+#include <insituc/transform/evaluator/evaluator.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <set>
+#include <deque>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace transform
+{
+
+namespace
+{
+
+struct specializer
+{
+
+    frozen_variables const & frozen_variables_;
+    std::deque< std::set< ast::identifier > > scopes_ = {};
+
+    bool
+    is_shadowed(ast::identifier const & _identifier) const
+    {
+        for (std::set< ast::identifier > const & scope_ : scopes_) {
+            if (scope_.find(_identifier) != std::end(scope_)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void
+    declare(ast::lvalues const & _lvalues)
+    {
+        assert(!scopes_.empty());
+        for (ast::lvalue const & lvalue_ : _lvalues) {
+            scopes_.back().insert(lvalue_);
+        }
+    }
+
+    [[noreturn]]
+    ast::operand
+    specialize_operand(ast::empty const & /*_empty*/) const
+    {
+        throw std::runtime_error("empty operand in expression is not allowed");
+    }
+
+    ast::operand
+    specialize_operand(G const & _value) const
+    {
+        return _value;
+    }
+
+    ast::operand
+    specialize_operand(ast::constant const _constant) const
+    {
+        return _constant;
+    }
+
+    ast::operand
+    specialize_operand(ast::intrinsic_invocation const & _ast) const
+    {
+        return ast::intrinsic_invocation{_ast.intrinsic_, {operator () (_ast.argument_list_.rvalues_)}};
+    }
+
+    ast::operand
+    specialize_operand(ast::entry_substitution const & _ast) const
+    {
+        return ast::entry_substitution{_ast.entry_name_, {operator () (_ast.argument_list_.rvalues_)}};
+    }
+
+    ast::operand
+    specialize_operand(ast::identifier const & _identifier) const
+    {
+        if (!is_shadowed(_identifier)) {
+            auto const frozen_variable_ = frozen_variables_.find(_identifier);
+            if (frozen_variable_ != std::end(frozen_variables_)) {
+                return frozen_variable_->second;
+            }
+        }
+        return _identifier;
+    }
+
+    ast::operand
+    specialize_operand(ast::unary_expression const & _ast) const
+    {
+        return ast::unary_expression{_ast.operator_, operator () (_ast.operand_)};
+    }
+
+    ast::operand
+    specialize_operand(ast::binary_expression const & _ast) const
+    {
+        return ast::binary_expression{operator () (_ast.lhs_), _ast.operator_, operator () (_ast.rhs_)};
+    }
+
+    ast::operand
+    specialize_operand(ast::expression const & _expression) const
+    {
+        ast::operation_list rest_;
+        for (ast::operation const & operation_ : _expression.rest_) {
+            rest_.push_back({operation_.operator_, operator () (operation_.operand_)});
+        }
+        return ast::expression{operator () (_expression.first_), std::move(rest_)};
+    }
+
+    ast::operand
+    specialize_operand(ast::rvalue_list const & _rvalue_list) const
+    {
+        return ast::rvalue_list{operator () (_rvalue_list.rvalues_), _rvalue_list.pragma_};
+    }
+
+    ast::operand
+    specialize_operand(ast::operand_cptr const _operand_cptr) const
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    ast::operand
+    operator () (ast::operand const & _operand) const
+    {
+        return visit([&] (auto const & o) -> ast::operand
+        {
+            return specialize_operand(o);
+        }, *_operand);
+    }
+
+    ast::rvalues
+    operator () (ast::rvalues const & _rvalues) const
+    {
+        ast::rvalues rvalues_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            rvalues_.push_back(operator () (rvalue_));
+        }
+        return rvalues_;
+    }
+
+    ast::statement
+    specialize_statement(ast::empty const & _empty)
+    {
+        return _empty;
+    }
+
+    ast::statement
+    specialize_statement(ast::variable_declaration const & _ast)
+    {
+        ast::rvalues rhs_ = operator () (_ast.rhs_.rvalues_);
+        declare(_ast.lhs_.lvalues_);
+        return ast::variable_declaration{_ast.lhs_, {std::move(rhs_)}};
+    }
+
+    ast::statement
+    specialize_statement(ast::assignment const & _assignment)
+    {
+        for (ast::lvalue const & lvalue_ : _assignment.lhs_.lvalues_) {
+            if (!is_shadowed(lvalue_) && (frozen_variables_.find(lvalue_) != std::end(frozen_variables_))) {
+                throw std::runtime_error("frozen global variable cannot be assigned");
+            }
+        }
+        return ast::assignment{_assignment.lhs_, _assignment.operator_, {operator () (_assignment.rhs_.rvalues_)}};
+    }
+
+    ast::statement
+    specialize_statement(ast::statement_block const & _statement_block)
+    {
+        scopes_.emplace_back();
+        ast::statements statements_ = operator () (_statement_block.statements_);
+        scopes_.pop_back();
+        return ast::statement_block{std::move(statements_)};
+    }
+
+    ast::statement
+    operator () (ast::statement const & _statement)
+    {
+        return visit([&] (auto const & s) -> ast::statement
+        {
+            return specialize_statement(s);
+        }, *_statement);
+    }
+
+    ast::statements
+    operator () (ast::statements const & _statements)
+    {
+        ast::statements statements_;
+        for (ast::statement const & statement_ : _statements) {
+            statements_.push_back(operator () (statement_));
+        }
+        return statements_;
+    }
+
+    ast::entry_definition
+    operator () (ast::entry_definition const & _entry)
+    {
+        assert(scopes_.empty());
+        scopes_.emplace_back(std::cbegin(_entry.argument_list_.lvalues_), std::cend(_entry.argument_list_.lvalues_));
+        ast::statements statements_ = operator () (_entry.body_.statements_);
+        ast::rvalues rvalues_ = operator () (_entry.return_statement_.rvalues_);
+        scopes_.pop_back();
+        return {_entry.entry_name_, _entry.argument_list_, {std::move(statements_)}, {std::move(rvalues_), _entry.return_statement_.pragma_}};
+    }
+
+};
+
+}
+
+ast::program
+specialize(ast::program const & _program,
+           frozen_variables const & _frozen_variables)
+{
+    ast::program program_;
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        program_.append(specializer{_frozen_variables}(entry_));
+    }
+    return evaluate(std::move(program_));
+}
+
+}
+}
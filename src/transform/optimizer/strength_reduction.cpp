@@ -0,0 +1,367 @@
+#include <insituc/transform/optimizer/strength_reduction.hpp>
+
+#include <insituc/ast/compare.hpp>
+#include <insituc/floating_point_type.hpp>
+#include <insituc/utility/numeric/exact_reciprocal.hpp>
+#include <insituc/utility/append.hpp>
+
+#include <versatile/visit.hpp>
+
+#include <experimental/optional>
+
+#include <utility>
+#include <initializer_list>
+#include <stdexcept>
+
+#include <cassert>
+
+namespace insituc
+{
+namespace transform
+{
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+namespace
+{
+
+using U = ast::unary_expression;
+using B = ast::binary_expression;
+using I = ast::intrinsic_invocation;
+using R = ast::rvalue_list;
+using O = ast::operand;
+
+constexpr size_type max_exponent = 1024; // limits length of the multiplication chain
+
+G const *
+literal(O const & _operand)
+{
+    O const & operand_ = ast::unref(_operand);
+    if (auto const * const rvalue_list_ = get< R >(&operand_)) {
+        if (rvalue_list_->rvalues_.size() == 1) {
+            return literal(rvalue_list_->rvalues_.back());
+        }
+        return nullptr;
+    }
+    return get< G >(&operand_);
+}
+
+I const *
+unary_invocation(O const & _operand, ast::intrinsic const _intrinsic)
+{
+    if (auto const * const intrinsic_invocation_ = get< I >(&ast::unref(_operand))) {
+        if ((intrinsic_invocation_->intrinsic_ == _intrinsic) && (intrinsic_invocation_->argument_list_.rvalues_.size() == 1)) {
+            return intrinsic_invocation_;
+        }
+    }
+    return nullptr;
+}
+
+O
+invoke(ast::intrinsic const _intrinsic, O && _argument)
+{
+    return I{_intrinsic, {append< ast::rvalues >(std::move(_argument))}};
+}
+
+bool
+is_two(O const & _operand)
+{
+    G const * const value_ = literal(_operand);
+    return (value_ && (*value_ == G(2)));
+}
+
+O
+power(O const & _base, size_type _exponent) // binary exponentiation
+{
+    assert(0 < _exponent);
+    O power_;
+    O square_ = _base;
+    for (;;) {
+        if ((_exponent & 1) != 0) {
+            if (power_.empty()) {
+                power_ = square_;
+            } else {
+                power_ = B{std::move(power_), ast::binary::mul, square_};
+            }
+        }
+        _exponent >>= 1;
+        if (_exponent == 0) {
+            break;
+        }
+        square_ = invoke(ast::intrinsic::sqr, std::move(square_));
+    }
+    return power_;
+}
+
+std::experimental::optional< O >
+reduce_power(O const & _base, O const & _exponent)
+{
+    G const * const exponent_ = literal(_exponent);
+    if (!exponent_) {
+        return {};
+    }
+    G const magnitude_ = abs(*exponent_);
+    if ((trunc(magnitude_) == magnitude_) && !(static_cast< G >(static_cast< F >(max_exponent)) < magnitude_)) {
+        if (magnitude_ == zero) {
+            return O{one}; // x ^ 0 = 1
+        }
+        O power_ = power(_base, static_cast< size_type >(static_cast< F >(magnitude_)));
+        if (*exponent_ < zero) {
+            return O{B{one, ast::binary::div, std::move(power_)}};
+        }
+        return std::move(power_);
+    }
+    if (magnitude_ == G(0.5)) {
+        O sqrt_ = invoke(ast::intrinsic::sqrt, O{_base});
+        if (*exponent_ < zero) {
+            return O{B{one, ast::binary::div, std::move(sqrt_)}};
+        }
+        return std::move(sqrt_);
+    }
+    return {};
+}
+
+std::experimental::optional< O >
+merge_exponents(O const & _lhs, ast::binary const _operator, O const & _rhs)
+{ // exp(a) * exp(b) = exp(a + b), exp(a) / exp(b) = exp(a - b), the same for pow2
+    for (ast::intrinsic const intrinsic_ : {ast::intrinsic::exp, ast::intrinsic::pow2}) {
+        I const * const lhs_ = unary_invocation(_lhs, intrinsic_);
+        if (!lhs_) {
+            continue;
+        }
+        I const * const rhs_ = unary_invocation(_rhs, intrinsic_);
+        if (!rhs_) {
+            continue;
+        }
+        return invoke(intrinsic_, B{lhs_->argument_list_.rvalues_.back(), _operator, rhs_->argument_list_.rvalues_.back()});
+    }
+    return {};
+}
+
+struct strength_reduction
+{
+
+    size_type const fast_math_; // expansion of powers and merging of exponents change rounding, done for level 2 only
+
+    [[noreturn]]
+    O
+    reduce_operand(ast::empty const & /*_empty*/) const
+    {
+        throw std::runtime_error("empty operand in expression is not allowed");
+    }
+
+    O
+    reduce_operand(G const & _value) const
+    {
+        return _value;
+    }
+
+    O
+    reduce_operand(ast::constant const _constant) const
+    {
+        return _constant;
+    }
+
+    O
+    reduce_operand(I const & _ast) const
+    {
+        ast::rvalues arguments_ = operator () (_ast.argument_list_.rvalues_);
+        if ((1 < fast_math_) && (_ast.intrinsic_ == ast::intrinsic::pow) && (arguments_.size() == 2)) {
+            if (auto power_ = reduce_power(arguments_.front(), arguments_.back())) {
+                return std::move(*power_);
+            }
+        }
+        return I{_ast.intrinsic_, {std::move(arguments_), _ast.argument_list_.pragma_}};
+    }
+
+    O
+    reduce_operand(ast::entry_substitution const & _ast) const
+    {
+        return ast::entry_substitution{_ast.entry_name_, {operator () (_ast.argument_list_.rvalues_), _ast.argument_list_.pragma_}};
+    }
+
+    O
+    reduce_operand(ast::identifier const & _identifier) const
+    {
+        return _identifier;
+    }
+
+    O
+    reduce_operand(U const & _ast) const
+    {
+        return U{_ast.operator_, operator () (_ast.operand_)};
+    }
+
+    O
+    reduce_operand(B const & _ast) const
+    {
+        O lhs_ = operator () (_ast.lhs_);
+        O rhs_ = operator () (_ast.rhs_);
+        switch (_ast.operator_) {
+        case ast::binary::add : {
+            if (lhs_ == rhs_) {
+                return invoke(ast::intrinsic::twice, std::move(lhs_));
+            }
+            break;
+        }
+        case ast::binary::sub : {
+            break;
+        }
+        case ast::binary::mul : {
+            if (lhs_ == rhs_) {
+                return invoke(ast::intrinsic::sqr, std::move(lhs_));
+            } else if (is_two(lhs_)) {
+                return invoke(ast::intrinsic::twice, std::move(rhs_));
+            } else if (is_two(rhs_)) {
+                return invoke(ast::intrinsic::twice, std::move(lhs_));
+            } else if (fast_math_ < 2) {
+                break;
+            } else if (auto product_ = merge_exponents(lhs_, ast::binary::add, rhs_)) {
+                return std::move(*product_);
+            }
+            break;
+        }
+        case ast::binary::div : {
+            if (G const * const divisor_ = literal(rhs_)) {
+                if (has_exact_reciprocal(*divisor_)) {
+                    return B{std::move(lhs_), ast::binary::mul, one / *divisor_};
+                }
+            } else if (fast_math_ < 2) {
+                break;
+            } else if (auto quotient_ = merge_exponents(lhs_, ast::binary::sub, rhs_)) {
+                return std::move(*quotient_);
+            }
+            break;
+        }
+        case ast::binary::mod : {
+            break;
+        }
+        case ast::binary::pow : {
+            if (fast_math_ < 2) {
+                break;
+            }
+            if (auto power_ = reduce_power(lhs_, rhs_)) {
+                return std::move(*power_);
+            }
+            break;
+        }
+        }
+        return B{std::move(lhs_), _ast.operator_, std::move(rhs_)};
+    }
+
+    O
+    reduce_operand(ast::expression const & _expression) const
+    { // precedence is not resolved yet, only operands are reduced
+        ast::operation_list rest_;
+        for (ast::operation const & operation_ : _expression.rest_) {
+            rest_.push_back({operation_.operator_, operator () (operation_.operand_)});
+        }
+        return ast::expression{operator () (_expression.first_), std::move(rest_)};
+    }
+
+    O
+    reduce_operand(R const & _rvalue_list) const
+    {
+        return R{operator () (_rvalue_list.rvalues_), _rvalue_list.pragma_};
+    }
+
+    O
+    reduce_operand(ast::operand_cptr const _operand_cptr) const
+    {
+        return operator () (*_operand_cptr);
+    }
+
+    O
+    operator () (O const & _operand) const
+    {
+        return visit([&] (auto const & o) -> O
+        {
+            return reduce_operand(o);
+        }, *_operand);
+    }
+
+    ast::rvalues
+    operator () (ast::rvalues const & _rvalues) const
+    {
+        ast::rvalues rvalues_;
+        for (ast::rvalue const & rvalue_ : _rvalues) {
+            rvalues_.push_back(operator () (rvalue_));
+        }
+        return rvalues_;
+    }
+
+    ast::statement
+    reduce_statement(ast::empty const & _empty) const
+    {
+        return _empty;
+    }
+
+    ast::statement
+    reduce_statement(ast::variable_declaration const & _ast) const
+    {
+        return ast::variable_declaration{_ast.lhs_, {operator () (_ast.rhs_.rvalues_)}};
+    }
+
+    ast::statement
+    reduce_statement(ast::assignment const & _assignment) const
+    {
+        return ast::assignment{_assignment.lhs_, _assignment.operator_, {operator () (_assignment.rhs_.rvalues_)}};
+    }
+
+    ast::statement
+    reduce_statement(ast::statement_block const & _statement_block) const
+    {
+        return ast::statement_block{operator () (_statement_block.statements_)};
+    }
+
+    ast::statement
+    operator () (ast::statement const & _statement) const
+    {
+        return visit([&] (auto const & s) -> ast::statement
+        {
+            return reduce_statement(s);
+        }, *_statement);
+    }
+
+    ast::statements
+    operator () (ast::statements const & _statements) const
+    {
+        ast::statements statements_;
+        for (ast::statement const & statement_ : _statements) {
+            statements_.push_back(operator () (statement_));
+        }
+        return statements_;
+    }
+
+    ast::entry_definition
+    operator () (ast::entry_definition const & _entry) const
+    {
+        if (fast_math_ == 0) {
+            return _entry; // strict IEEE
+        }
+        return {_entry.entry_name_, _entry.argument_list_, {operator () (_entry.body_.statements_)}, {operator () (_entry.return_statement_.rvalues_), _entry.return_statement_.pragma_}};
+    }
+
+};
+
+}
+#pragma clang diagnostic pop
+
+ast::entry_definition
+reduce_strength(ast::entry_definition const & _entry)
+{
+    return strength_reduction{_entry.return_statement_.pragma_.options_.fast_math_level()}(_entry);
+}
+
+ast::program
+reduce_strength(ast::program const & _program)
+{
+    ast::program program_;
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        program_.append(reduce_strength(entry_));
+    }
+    return program_;
+}
+
+}
+}
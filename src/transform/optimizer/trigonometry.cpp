@@ -0,0 +1,224 @@
+#include <insituc/transform/optimizer/trigonometry.hpp>
+
+#include <insituc/transform/optimizer/hoisting.hpp>
+#include <insituc/floating_point_type.hpp>
+#include <insituc/utility/append.hpp>
+
+#include <experimental/optional>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <utility>
+#include <iterator>
+
+namespace insituc
+{
+namespace transform
+{
+
+namespace
+{
+
+enum class pairing
+{
+    sincos,
+    tg,
+};
+
+struct occurrence
+{
+
+    bool sin_ = false;
+    bool cos_ = false;
+    bool tg_ = false;
+    bool ctg_ = false;
+
+};
+
+struct shared
+{
+
+    ast::rvalues results_; // (sin, cos) or (tg)
+    std::set< ast::identifier > dependencies_;
+
+};
+
+using shareds = std::unordered_map< ast::operand_cptr, shared, operand_cptr_hash, operand_cptr_equal >; // keyed by the argument
+
+struct available
+{
+
+    shareds sincos_;
+    shareds tg_;
+
+};
+
+struct trigonometric_pairs
+    : hoisting< trigonometric_pairs, available >
+{
+
+    using occurrences = std::unordered_map< ast::operand_cptr, std::map< size_type, occurrence >, operand_cptr_hash, operand_cptr_equal >; // by epoch
+
+    occurrences occurrences_;
+
+    static
+    ast::operand const *
+    unary_argument(ast::intrinsic_invocation const & _ast)
+    {
+        if (_ast.argument_list_.rvalues_.size() != 1) {
+            return nullptr;
+        }
+        return &ast::unref(_ast.argument_list_.rvalues_.back());
+    }
+
+    // first pass: occurrences of the trigonometric functions for each argument
+
+    bool
+    count_node(ast::operand const & _operand)
+    {
+        if (auto const * const intrinsic_invocation_ = get< ast::intrinsic_invocation >(&_operand)) {
+            if (ast::operand const * const argument_ = unary_argument(*intrinsic_invocation_)) {
+                switch (intrinsic_invocation_->intrinsic_) {
+                case ast::intrinsic::sin : {
+                    occurrences_[argument_][epoch(*argument_)].sin_ = true;
+                    break;
+                }
+                case ast::intrinsic::cos : {
+                    occurrences_[argument_][epoch(*argument_)].cos_ = true;
+                    break;
+                }
+                case ast::intrinsic::tg : {
+                    occurrences_[argument_][epoch(*argument_)].tg_ = true;
+                    break;
+                }
+                case ast::intrinsic::ctg : {
+                    occurrences_[argument_][epoch(*argument_)].ctg_ = true;
+                    break;
+                }
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wswitch-enum"
+#pragma clang diagnostic ignored "-Wcovered-switch-default"
+                default : {
+                    break;
+                }
+#pragma clang diagnostic pop
+                }
+            }
+        }
+        return true;
+    }
+
+    // second pass: hoisting of the paired invocations
+
+    bool
+    is_paired(ast::operand const & _argument, pairing const _pairing) const
+    {
+        auto const argument_ = occurrences_.find(&_argument);
+        if (argument_ == std::end(occurrences_)) {
+            return false;
+        }
+        auto const occurrence_ = argument_->second.find(epoch(_argument));
+        if (occurrence_ == std::end(argument_->second)) {
+            return false;
+        }
+        switch (_pairing) {
+        case pairing::sincos : return (occurrence_->second.sin_ && occurrence_->second.cos_);
+        case pairing::tg     : return (occurrence_->second.tg_ && occurrence_->second.ctg_);
+        }
+        return false;
+    }
+
+    ast::rvalues const &
+    share(ast::operand const & _argument, pairing const _pairing)
+    {
+        shareds & shareds_ = ((_pairing == pairing::sincos) ? available_.sincos_ : available_.tg_);
+        auto const available_shared_ = shareds_.find(&_argument);
+        if (available_shared_ != std::end(shareds_)) {
+            return available_shared_->second.results_;
+        }
+        ast::lvalues lvalues_ = ((_pairing == pairing::sincos) ? make_hidden({"_sin", "_cos"}) : make_hidden({"_tg"}));
+        ast::intrinsic const intrinsic_ = ((_pairing == pairing::sincos) ? ast::intrinsic::sincos : ast::intrinsic::tg);
+        ast::rvalues results_ = hoist(std::move(lvalues_), ast::operand{ast::intrinsic_invocation{intrinsic_, {append< ast::rvalues >(operator () (_argument))}}});
+        std::set< ast::identifier > dependencies_;
+        dependencies{dependencies_}(_argument);
+        return shareds_.emplace(&_argument, shared{std::move(results_), std::move(dependencies_)}).first->second.results_;
+    }
+
+    std::experimental::optional< ast::operand >
+    substitute(ast::operand const & _operand)
+    {
+        auto const * const intrinsic_invocation_ = get< ast::intrinsic_invocation >(&_operand);
+        if (!intrinsic_invocation_) {
+            return {};
+        }
+        ast::operand const * const argument_ = unary_argument(*intrinsic_invocation_);
+        if (!argument_) {
+            return {};
+        }
+        switch (intrinsic_invocation_->intrinsic_) {
+        case ast::intrinsic::sin : {
+            if (is_paired(*argument_, pairing::sincos)) {
+                return share(*argument_, pairing::sincos).front();
+            }
+            break;
+        }
+        case ast::intrinsic::cos : {
+            if (is_paired(*argument_, pairing::sincos)) {
+                return share(*argument_, pairing::sincos).back();
+            }
+            break;
+        }
+        case ast::intrinsic::tg : {
+            if (is_paired(*argument_, pairing::tg)) {
+                return share(*argument_, pairing::tg).back();
+            }
+            break;
+        }
+        case ast::intrinsic::ctg : {
+            if (is_paired(*argument_, pairing::tg)) { // fptan loads 1 anyway, ctg(x) is 1 / tg(x) exactly as it is compiled
+                return ast::operand{ast::binary_expression{one, ast::binary::div, share(*argument_, pairing::tg).back()}};
+            }
+            break;
+        }
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wswitch-enum"
+#pragma clang diagnostic ignored "-Wcovered-switch-default"
+        default : {
+            break;
+        }
+#pragma clang diagnostic pop
+        }
+        return {};
+    }
+
+    static
+    void
+    invalidate(available & _available,
+               ast::lvalues const & _lvalues)
+    {
+        hoisting::invalidate(_available.sincos_, _lvalues);
+        hoisting::invalidate(_available.tg_, _lvalues);
+    }
+
+};
+
+}
+
+ast::entry_definition
+pair_trigonometric_functions(ast::entry_definition const & _entry)
+{
+    return trigonometric_pairs{}(_entry);
+}
+
+ast::program
+pair_trigonometric_functions(ast::program const & _program)
+{
+    ast::program program_;
+    for (ast::entry_definition const & entry_ : _program.entries_) {
+        program_.append(pair_trigonometric_functions(entry_));
+    }
+    return program_;
+}
+
+}
+}
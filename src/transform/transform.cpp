@@ -3,6 +3,14 @@
 #include <insituc/transform/derivator/derivator.hpp>
 
 #include <insituc/utility/append.hpp>
+#include <insituc/utility/parallel_for.hpp>
+
+#include <set>
+#include <map>
+#include <deque>
+#include <vector>
+#include <iterator>
+#include <utility>
 
 namespace insituc
 {
@@ -20,5 +28,108 @@ Jacobian(ast::program const & _functions,
     return derivatives_;
 }
 
+ast::programs
+Jacobian(derivative_cache & _cache,
+         ast::symbols _wrts)
+{
+    ast::programs derivatives_;
+    for (ast::symbol & wrt_ : _wrts) {
+        derivatives_.push_back(derive(_cache, append< ast::symbols >(std::move(wrt_))));
+    }
+    return derivatives_;
+}
+
+namespace
+{
+
+std::vector< size_type >
+columns(ast::symbols const & _wrts, ast::symbols & _distinct_wrts) // index of the first occurrence of each wrt among the _distinct_wrts
+{
+    std::map< ast::symbol, size_type > first_;
+    std::vector< size_type > columns_;
+    for (ast::symbol const & wrt_ : _wrts) {
+        auto const column_ = first_.emplace(wrt_, _distinct_wrts.size());
+        if (column_.second) {
+            _distinct_wrts.push_back(wrt_);
+        }
+        columns_.push_back(column_.first->second);
+    }
+    return columns_;
+}
+
+ast::programs
+spread(ast::programs && _derivatives, std::vector< size_type > const & _columns) // repeated columns are copied
+{
+    ast::programs derivatives_;
+    std::vector< bool > moved_(_derivatives.size(), false);
+    for (size_type const column_ : _columns) {
+        if (moved_[column_]) {
+            derivatives_.push_back(_derivatives[column_]);
+        } else {
+            derivatives_.push_back(std::move(_derivatives[column_]));
+            moved_[column_] = true;
+        }
+    }
+    return derivatives_;
+}
+
+}
+
+ast::programs
+Jacobian_parallel(ast::program const & _functions,
+                  ast::symbols const & _wrts,
+                  size_type _concurrency)
+{
+    ast::symbols wrts_;
+    std::vector< size_type > const columns_ = columns(_wrts, wrts_);
+    ast::programs derivatives_(wrts_.size());
+    parallel_for(wrts_.size(), _concurrency, [&] (size_type const i)
+    {
+        derivatives_[i] = derive(_functions, append< ast::symbols >(wrts_[i]));
+    });
+    return spread(std::move(derivatives_), columns_);
+}
+
+ast::programs
+Jacobian_parallel(derivative_cache & _cache,
+                  ast::symbols const & _wrts,
+                  size_type _concurrency)
+{
+    ast::symbols wrts_;
+    std::vector< size_type > const columns_ = columns(_wrts, wrts_);
+    std::deque< ast::symbols > distinct_columns_;
+    for (ast::symbol const & wrt_ : wrts_) {
+        distinct_columns_.push_back(append< ast::symbols >(wrt_));
+    }
+    return spread(derive_columns_parallel(_cache, distinct_columns_, _concurrency), columns_);
+}
+
+ast::program
+Hessian(ast::program const & _functions,
+        ast::symbols const & _wrts)
+{
+    derivative_cache cache_{_functions};
+    Hessian(cache_, _wrts);
+    return cache_.release(); // everything derived is a part of the result
+}
+
+ast::program
+Hessian(derivative_cache & _cache,
+        ast::symbols const & _wrts)
+{
+    ast::program derivatives_;
+    std::set< ast::identifier > emitted_;
+    for (auto row_ = std::cbegin(_wrts); row_ != std::cend(_wrts); ++row_) {
+        for (auto column_ = row_; column_ != std::cend(_wrts); ++column_) {
+            for (ast::entry_definition & entry_ : derive(_cache, append< ast::symbols >(*row_, *column_)).entries_) {
+                if (emitted_.insert(entry_.entry_name_).second) {
+                    derivatives_.append(std::move(entry_));
+                }
+            }
+        }
+    }
+    return derivatives_;
+}
+
 }
 }
@@ -0,0 +1,112 @@
+#include <insituc/parser/parser.hpp>
+#include <insituc/parser/literal.hpp>
+
+#include <boost/spirit/home/x3.hpp>
+
+#include <random>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+
+#include <cstdlib>
+
+namespace
+{
+
+using namespace insituc;
+
+// coefficients as generated formula files have them: shortest round-trip and full precision ones, a few with exponents
+std::vector< std::string >
+make_literals(size_type const _count)
+{
+    std::mt19937_64 engine_;
+    std::uniform_real_distribution< F > mantissa_(F(-1), F(1));
+    std::uniform_int_distribution< int > exponent_(-30, 30);
+    std::vector< std::string > literals_;
+    literals_.reserve(_count);
+    for (size_type i = 0; i < _count; ++i) {
+        std::ostringstream oss_;
+        switch (i % 4) {
+        case 0 : oss_ << std::setprecision(6) << mantissa_(engine_); break;
+        case 1 : oss_ << std::setprecision(std::numeric_limits< F >::digits10) << mantissa_(engine_); break;
+        case 2 : oss_ << std::setprecision(std::numeric_limits< F >::max_digits10) << mantissa_(engine_); break;
+        case 3 : oss_ << std::setprecision(std::numeric_limits< F >::max_digits10) << mantissa_(engine_) << 'e' << exponent_(engine_); break;
+        }
+        literals_.push_back(oss_.str());
+    }
+    return literals_;
+}
+
+template< typename parse >
+double
+measure(std::vector< std::string > const & _literals, parse && _parse)
+{
+    auto const start_ = std::chrono::steady_clock::now();
+    F sum_ = F(0);
+    for (std::string const & literal_ : _literals) {
+        sum_ += _parse(literal_);
+    }
+    std::chrono::duration< double, std::nano > const elapsed_ = std::chrono::steady_clock::now() - start_;
+    if (!(sum_ == sum_)) {
+        std::cerr << "unexpected NaN" << std::endl;
+    }
+    return elapsed_.count() / static_cast< double >(_literals.size());
+}
+
+}
+
+int
+main(int argc, char * argv[])
+{
+    size_type const count_ = ((1 < argc) ? static_cast< size_type >(std::atol(argv[1])) : 1000000);
+    std::vector< std::string > const literals_ = make_literals(count_);
+    size_type mismatches_ = 0;
+    for (std::string const & literal_ : literals_) {
+        auto it = std::cbegin(literal_);
+        auto const value_ = parser::scan_real_literal(it, std::cend(literal_));
+        if (!value_ || (it != std::cend(literal_)) || !(*value_ == parser::literal::slow_path(literal_))) {
+            std::cerr << "incorrectly rounded: " << literal_ << std::endl;
+            ++mismatches_;
+        }
+    }
+    double const scan_ = measure(literals_, [] (std::string const & _literal) -> F
+    {
+        auto it = std::cbegin(_literal);
+        return *parser::scan_real_literal(it, std::cend(_literal));
+    });
+    double const x3_ = measure(literals_, [] (std::string const & _literal) -> F
+    {
+        F value_{};
+        auto it = std::cbegin(_literal);
+        boost::spirit::x3::parse(it, std::cend(_literal), boost::spirit::x3::real_parser< F >{}, value_);
+        return value_;
+    });
+    double const strto_ = measure(literals_, [] (std::string const & _literal) -> F
+    {
+        return parser::literal::slow_path(_literal);
+    });
+    std::ostringstream source_;
+    source_ << "function f(x) return ";
+    for (size_type i = 0; i < literals_.size(); ++i) {
+        source_ << ((i == 0) ? "" : " + x * ") << literals_[i];
+    }
+    source_ << " end";
+    std::string const polynomial_ = source_.str();
+    auto const start_ = std::chrono::steady_clock::now();
+    auto const parse_result_ = parser::parse(std::cbegin(polynomial_), std::cend(polynomial_));
+    std::chrono::duration< double, std::milli > const parse_time_ = std::chrono::steady_clock::now() - start_;
+    std::cout << "literals: " << count_ << ", incorrectly rounded: " << mismatches_ << "\n"
+              << "scan_real_literal: " << scan_ << " ns per literal\n"
+              << "x3::real_parser:   " << x3_ << " ns per literal\n"
+              << "strtod:            " << strto_ << " ns per literal\n"
+              << "coefficient-heavy source parse: " << parse_time_.count() << " ms" << (!!parse_result_.error_ ? " (failed)" : "") << std::endl;
+    if (mismatches_ != 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
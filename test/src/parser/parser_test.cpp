@@ -1,9 +1,29 @@
 #include <insituc/ast/io.hpp>
+#include <insituc/ast/compare.hpp>
+#include <insituc/ast/flat.hpp>
 #include <insituc/parser/parser.hpp>
+#include <insituc/parser/incremental.hpp>
+#include <insituc/parser/literal.hpp>
+#include <insituc/parser/pragma_parser.hpp>
+#include <insituc/transform/evaluator/evaluator.hpp>
+#include <insituc/memory/arena.hpp>
+
+#include <experimental/optional>
 
 #include <string>
 #include <iostream>
 #include <iterator>
+#include <exception>
+#include <limits>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+#include <insituc/debug/demangle.hpp>
+#include <typeinfo>
+#include <cxxabi.h>
 
 #ifdef __linux__
 #define GREEN(str) __extension__ "\e[1;32m" str "\e[0m"
@@ -11,11 +31,207 @@
 #define GREEN(str) str
 #endif
 
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmissing-field-initializers"
+namespace
+{
+
+using namespace std::string_literals;
+
+using namespace insituc;
+
+class test
+{
+
+    std::experimental::optional< ast::program >
+    parse(std::string const & _source) const
+    {
+        auto parse_result_ = parser::parse(std::cbegin(_source), std::cend(_source));
+        if (!!parse_result_.error_) {
+            auto const & error_description_ = *parse_result_.error_;
+            std::cerr << "Error: \"" << error_description_.which_
+                      << "\" at input position: ";
+            std::copy(error_description_.where_, error_description_.last_, std::ostreambuf_iterator< char_type >(std::cerr));
+            std::cerr << std::endl;
+            return {};
+        }
+        return std::move(parse_result_.ast_);
+    }
+
+    void
+    test_arena()
+    {
+        std::string const source_ = "function f(x, y) local a = sin(x) * cos(y) return a + sqr(x - y), -a end ";
+        auto const program_ = parse(source_);
+        assert(!!program_);
+        arena arena_;
+        {
+            arena::scope const scope_{arena_};
+            auto const arena_program_ = parse(source_);
+            assert(!!arena_program_);
+            assert(0 < arena_.size());
+            assert(*arena_program_ == *program_);
+        }
+    }
+
+    void
+    test_parallel_parsing()
+    {
+        std::string const source_ = "function f(x) return x end /* function g() end */ function g(x, y) begin local a = x end return x + y end // end\n"
+                                    "function h() return [[ end ]] 1 end ";
+        auto const sequential_ = parser::parse(std::cbegin(source_), std::cend(source_));
+        auto const parallel_ = parser::parse_parallel(std::cbegin(source_), std::cend(source_), 2);
+        assert(!sequential_.error_ && !parallel_.error_);
+        assert(parallel_.ast_.entries_.size() == 3);
+        assert(parallel_.ast_ == sequential_.ast_);
+        assert(parallel_.ranges_ == sequential_.ranges_);
+        assert(parallel_.ast_.tag_ == sequential_.ast_.tag_);
+        auto entry_ = std::cbegin(sequential_.ast_.entries_);
+        for (ast::entry_definition const & parallel_entry_ : parallel_.ast_.entries_) {
+            assert(parallel_entry_.tag_ == entry_->tag_);
+            assert(parallel_entry_.return_statement_.tag_ == entry_->return_statement_.tag_);
+            assert(parallel_entry_.return_statement_.pragma_.tag_ == entry_->return_statement_.pragma_.tag_);
+            ++entry_;
+        }
+        assert(parallel_.ast_.entries_.back().return_statement_.pragma_.tag_ != ast::ntag); // [[ end ]] of h, in the second chunk
+        auto const broken_ = parser::parse_parallel(std::cbegin(source_), std::prev(std::cend(source_), 4), 2);
+        assert(!!broken_.error_);
+    }
+
+    void
+    test_incremental_parsing()
+    {
+        std::string const source_ = "function f(x) return x end\nfunction g(y) return y end\nfunction h(z) return z end ";
+        auto previous_ = parser::parse(std::cbegin(source_), std::cend(source_));
+        assert(!previous_.error_);
+        size_type const f_tag_ = previous_.ast_.entries_.front().tag_;
+        size_type const h_tag_ = previous_.ast_.entries_.back().tag_;
+        size_type const offset_ = source_.find("return y") + 7;
+        std::string edited_ = source_;
+        edited_.replace(offset_, 1, "2 * y");
+        auto result_ = parser::reparse(std::move(previous_), std::cbegin(source_), std::cbegin(edited_), std::cend(edited_), {offset_, 1, 5});
+        assert(!result_.parse_result_.error_);
+        assert(result_.changed_entries_.size() == 1);
+        assert(result_.changed_entries_.front() == 1);
+        assert(result_.removed_entries_ == 1);
+        auto const fresh_ = parser::parse(std::cbegin(edited_), std::cend(edited_));
+        ast::program const & program_ = result_.parse_result_.ast_;
+        assert(program_ == fresh_.ast_);
+        assert(program_.entries_.front().tag_ == f_tag_);
+        assert(program_.entries_.back().tag_ == h_tag_);
+        auto const & ranges_ = result_.parse_result_.ranges_;
+        assert(ranges_.at(h_tag_) == fresh_.ranges_.at(fresh_.ast_.entries_.back().tag_));
+        assert(boost::spirit::get_line(ranges_.at(h_tag_).first) == 3);
+        std::string broken_ = edited_;
+        broken_.replace(offset_, 5, "2 *");
+        auto const failed_ = parser::reparse(std::move(result_.parse_result_), std::cbegin(edited_), std::cbegin(broken_), std::cend(broken_), {offset_, 5, 3});
+        assert(!!failed_.parse_result_.error_);
+        auto const & error_ = *failed_.parse_result_.error_;
+        assert(error_.first_.base() == std::cbegin(broken_));
+        assert(error_.last_.base() == std::cend(broken_));
+        assert(failed_.parse_result_.ast_ == fresh_.ast_);
+    }
+
+    void
+    test_flat_representation()
+    {
+        auto const source_ = parse("function f(x, y) local a, b = sincos(x) begin a += y end return [[ p ]] a * b + g(x) * pi, -sqr(a) end "
+                                   "function g(x) return x end ");
+        assert(!!source_);
+        ast::program const program_ = transform::evaluate(*source_);
+        ast::flat::program const flat_ = ast::flat::flatten(program_);
+        assert(flat_.names_.size() == 2);
+        for (ast::flat::index node_ = 0; node_ < flat_.size(); ++node_) {
+            auto const children_ = flat_.children(node_);
+            for (auto child_ = children_.first; child_ != children_.second; ++child_) {
+                assert(*child_ < node_);
+            }
+        }
+        assert(ast::flat::unflatten(flat_) == program_);
+    }
+
+    void
+    test_real_literals()
+    {
+        auto const is_parsed_to = [] (std::string const & _literal, F const _value) -> bool
+        {
+            auto const value_ = parser::parse_real_number(std::cbegin(_literal), std::cend(_literal));
+            return !!value_ && (*value_ == G(_value));
+        };
+        for (std::string const & literal_ : {"0.1"s, "-2.5e-3"s, "1."s, ".5"s, "+7E+2"s, "123456789012345678901234567890"s, "9007199254740993"s, "1e23"s, "2.2250738585072011e-308"s, "4.9406564584124654e-324"s, "0.000000000000000000000000000000000000001"s}) {
+            assert(is_parsed_to(literal_, parser::literal::slow_path(literal_))); // correctly rounded by the C library
+        }
+        assert(is_parsed_to("-inf", -std::numeric_limits< F >::infinity()));
+        for (std::string const & literal_ : {"1e"s, "."s, "1.2.3"s}) {
+            assert(!parser::parse_real_number(std::cbegin(literal_), std::cend(literal_)));
+        }
+        std::string const nan_ = "NaN";
+        auto const value_ = parser::parse_real_number(std::cbegin(nan_), std::cend(nan_));
+        assert(!!value_ && !(*value_ == *value_));
+    }
+
+    void
+    test_pragma_options()
+    {
+        auto const source_ = parse("function f(x) local y = [[ noinline ]] x return [[ fast_math = 1; vectorize; precision = 40; backend = jit; drop = 1; unroll = 4; inline = maybe; fast_math = 3 ]] y, x end");
+        assert(!!source_);
+        ast::entry_definition const & entry_ = source_->entries_.front();
+        ast::pragma_options const & options_ = entry_.return_statement_.pragma_.options_;
+        assert(options_.fast_math_ && (*options_.fast_math_ == 1));
+        assert(options_.fast_math_level() == 1);
+        assert(options_.vectorize_ && *options_.vectorize_);
+        assert(options_.precision_ && (*options_.precision_ == 40));
+        assert(options_.backend_ && (*options_.backend_ == ast::backend::jit));
+        assert(options_.drop_ == 1);
+        assert(!options_.inline_);
+        assert(options_.unknown_.size() == 3);
+        assert(options_.unknown_.at("unroll") == "4");
+        assert(options_.unknown_.at("inline") == "maybe");
+        assert(options_.unknown_.at("fast_math") == "3");
+        auto const & declaration_ = ast::get< ast::variable_declaration const & >(entry_.body_.statements_.front());
+        assert(declaration_.rhs_.pragma_.options_.inline_ && !*declaration_.rhs_.pragma_.options_.inline_);
+        assert(!parser::parse_pragma("").fast_math_);
+        assert(parser::parse_pragma("").fast_math_level() == 2);
+        assert(*parser::parse_pragma(" fast_math ").fast_math_ == 2);
+    }
+
+public:
+
+    bool
+    operator () ()
+    try {
+        test_arena();
+        test_parallel_parsing();
+        test_incremental_parsing();
+        test_flat_representation();
+        test_real_literals();
+        test_pragma_options();
+        return true;
+    } catch (std::exception const & _exception) {
+        std::cerr << "Exception raised: " << _exception.what() << std::endl;
+        return false;
+    } catch (...) {
+        if (std::type_info * et = abi::__cxa_current_exception_type()) {
+            std::cerr << "unhandled exception type: " << get_demangled_name(et->name()) << std::endl;
+        } else {
+            std::cerr << "unhandled unknown exception" << std::endl;
+        }
+        return false;
+    }
+
+};
+
+}
+#pragma clang diagnostic pop
+
 #include <cstdlib>
 
 int
 main(int argc, char * argv[])
 {
+    if (!test{}()) {
+        return EXIT_FAILURE;
+    }
     std::istream & in_ = std::cin;
     std::ostream & out_ = std::cout;
     std::ostream & err_ = std::cerr;
@@ -28,6 +244,9 @@ main(int argc, char * argv[])
             source_ += '\n';
         }
     }
+    if (source_.empty()) {
+        return EXIT_SUCCESS; // nothing to show, self tests only
+    }
     using namespace insituc;
     auto const parse_result_ = parser::parse(std::cbegin(source_), std::cend(source_));
     if (!!parse_result_.error_) {
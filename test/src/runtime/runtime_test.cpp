@@ -1,8 +1,10 @@
 #include <insituc/ast/tokens.hpp>
 #include <insituc/ast/io.hpp>
 #include <insituc/parser/parser.hpp>
+#include <insituc/parser/stream.hpp>
 
 #include <insituc/meta/compiler.hpp>
+#include <insituc/meta/batch.hpp>
 #include <insituc/meta/io.hpp>
 
 #include <insituc/transform/evaluator/evaluator.hpp>
@@ -115,6 +117,37 @@ class test
         return true;
     }
 
+    bool
+    build_streamed(std::string const & _filename)
+    {
+        auto const error_ = parser::parse_file("test/cases/" + _filename, [&] (ast::entry_definition && _entry) -> bool
+        {
+            ast::program program_;
+            program_.append(std::move(_entry));
+            if (simplify_) {
+                program_ = transform::evaluate(std::move(program_));
+            }
+            if (!compiler_(program_)) {
+                std::cerr << "Compilation error. File \"" << _filename << "\". AST: " << std::endl
+                          << program_ << std::endl;
+                return false;
+            }
+            return true;
+        });
+        if (!!error_) {
+            std::cerr << "Streamed parse failure! File: \"" << _filename << "\". Error: " << *error_ << std::endl;
+            return false;
+        }
+        if (!interpret_) {
+            if (!translator_(assembler_)) {
+                std::cerr << "Translation error. File \"" << _filename << "\"." << std::endl;
+                return false;
+            }
+            instance_ = std::move(translator_);
+        }
+        return true;
+    }
+
     bool
     add_global(string_type && _symbol, G && _value = G(zero))
     {
@@ -397,6 +430,16 @@ class test
         assert(check(G(101), zero, one, G(10)));
         assert(cleanup());
 
+        assert(build("builtin_function_wrappers/sumsqr_wide.txt"));
+        assert(check(zero, zero));
+        assert(check(G(4224), one));
+        assert(cleanup());
+
+        assert(build("builtin_function_wrappers/sumsqr_wide_strict.txt"));
+        assert(check(zero, zero));
+        assert(check(G(4224), one));
+        assert(cleanup());
+
         assert(build("builtin_function_wrappers/round.txt"));
         assert(check(one, G(1.49)));
         assert(cleanup());
@@ -517,6 +560,14 @@ class test
         assert(check(G(0.832), G(-2), one, G(0.1), G(0.01), G(0.001)));
         assert(cleanup());
 
+        assert(build("builtin_function_wrappers/poly_estrin.txt"));
+        assert(check(G(2047 + 1023 + 1026), G(2)));
+        assert(cleanup());
+
+        assert(build("builtin_function_wrappers/poly_horner.txt"));
+        assert(check(G(2047 + 1023 + 1026), G(2)));
+        assert(cleanup());
+
         assert(build("builtin_function_wrappers/frac.txt"));
         assert(check(zero, pi< G >(), pi_minus_three< G >()));
         assert(cleanup());
@@ -628,6 +679,28 @@ class test
         assert(build("builtin_function_wrappers/min_pack.txt"));
         assert(check(zero));
         assert(cleanup());
+
+        assert(build("builtin_function_wrappers/sign.txt"));
+        assert(check(-one, G(-2)));
+        assert(check(zero, zero));
+        assert(check(one, G(3)));
+        if (!interpret_) { // virtual machine rejects comparisons of NaN
+            assert(isnan(call(G(std::numeric_limits< F >::quiet_NaN()))));
+        }
+        assert(cleanup());
+
+        assert(build("builtin_function_wrappers/pickmax.txt"));
+        assert(check(G(20), G(1), G(10), G(3), G(20), G(2), G(30)));
+        assert(check(G(10), G(3), G(10), G(3), G(20), G(1), G(30))); // first of the greatest
+        assert(cleanup());
+
+        assert(build("builtin_function_wrappers/pickmin.txt"));
+        assert(check(G(10), G(1), G(10), G(3), G(20), G(2), G(30)));
+        assert(check(G(20), G(3), G(10), G(1), G(20), G(1), G(30))); // first of the least
+        if (!interpret_) { // virtual machine rejects comparisons of NaN
+            assert(check(G(10), G(1), G(10), G(std::numeric_limits< F >::quiet_NaN()), G(20), G(2), G(30))); // NaN is never picked, as in constant folding
+        }
+        assert(cleanup());
     }
 
     void
@@ -754,6 +827,63 @@ class test
         assert(cleanup());
     }
 
+    void
+    test_batch_build()
+    {
+        ast::programs programs_;
+        for (string_type const & source_ : {"function g(x) return x * 0.25 end function f(x, y) return g(x) + y + 0.25 end"s,
+                                            "function f(x) return x * 0.25 + 1 end"s}) {
+            auto parse_result_ = parser::parse(std::cbegin(source_), std::cend(source_));
+            assert(!parse_result_.error_);
+            programs_.push_back(simplify_ ? transform::evaluate(std::move(parse_result_.ast_)) : std::move(parse_result_.ast_));
+        }
+        meta::entry_tables entry_tables_;
+        assert(meta::compile_batch(assembler_, programs_, entry_tables_));
+        assert(entry_tables_.size() == 2);
+        assert(entry_tables_.front().size() == 2);
+        assert(meta::compile_batch(assembler_, ast::programs{programs_.back()}, entry_tables_)); // names of the first call are taken
+        assert(entry_tables_.size() == 3);
+        if (!interpret_) {
+            assert(translator_(assembler_));
+            instance_ = std::move(translator_);
+        }
+        auto const call_ = [&] (size_type const _program, string_type const & _entry, auto &&... _arguments) -> G
+        {
+            ast::identifier entry_;
+            entry_.symbol_.name_ = _entry;
+            size_type const function_ = entry_tables_.at(_program).at(entry_);
+            if (interpret_) {
+                if (!virtual_machine_(function_, _arguments...)) {
+                    throw std::runtime_error("interpretation error");
+                }
+                return virtual_machine_.get_result();
+            } else {
+                return static_cast< G >(instance_(function_, _arguments...));
+            }
+        };
+        assert(abs(call_(0, "f", G(4), G(2)) - G(3.25)) < eps);
+        assert(abs(call_(1, "f", G(4)) - G(2)) < eps);
+        assert(abs(call_(0, "g", G(8)) - G(2)) < eps);
+        assert(abs(call_(2, "f", G(8)) - G(3)) < eps);
+        assert(cleanup());
+    }
+
+    void
+    test_inlining()
+    {
+        assert(build("inline.txt"));
+        assert(check(G(17.5), G(4), G(2)));
+        assert(cleanup());
+    }
+
+    void
+    test_streamed_build()
+    {
+        assert(build_streamed("streamed.txt"));
+        assert(check(G(10), G(2), G(3)));
+        assert(cleanup());
+    }
+
 public:
 
     test(bool const _simplify, bool const _interpret)
@@ -781,6 +911,9 @@ public:
         test_vector_assignment();
         test_logical_brackets();
         stack_overflow();
+        test_streamed_build();
+        test_batch_build();
+        test_inlining();
         return true;
     } catch (std::exception const & _exception) {
         std::cerr << "Exception raised: " << _exception.what() << std::endl;
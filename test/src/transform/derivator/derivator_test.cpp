@@ -1,4 +1,6 @@
 #include <insituc/transform/derivator/derivator.hpp>
+#include <insituc/transform/derivator/gradient.hpp>
+#include <insituc/transform/derivator/sparsity.hpp>
 #include <insituc/transform/evaluator/evaluator.hpp>
 #include <insituc/transform/transform.hpp>
 
@@ -17,6 +19,7 @@
 #include <string>
 #include <initializer_list>
 #include <deque>
+#include <future>
 
 #ifdef NDEBUG
 #undef NDEBUG
@@ -96,6 +99,46 @@ class test
         return true;
     }
 
+    template< typename generator >
+    bool
+    is_generated(generator && _generator,
+                 std::string const & _primitive,
+                 std::string const & _model)
+    {
+        auto const ast_ = parse(_model);
+        if (!ast_) {
+            std::cerr << "Can't parse _model" << std::endl;
+            return false;
+        }
+        ast::program const rhs_ = transform::evaluate(*ast_);
+        auto const lhs_ = parse(_primitive);
+        if (!lhs_) {
+            std::cerr << "Can't parse _primitive" << std::endl;
+            return false;
+        }
+        ast::program const source_ = transform::evaluate(*lhs_);
+        ast::entry_definition const & model_ = rhs_.entries_.back();
+        ast::entry_definition const result_ = std::forward< generator >(_generator)(source_.entries_.back(), model_.entry_name_.symbol_);
+        using namespace std::rel_ops;
+        if (result_ != model_) {
+            std::cerr << "Generated entry does not match the model." << std::endl
+                      << "Primitive:" << std::endl << source_ << std::endl
+                      << "Result:" << std::endl << result_ << std::endl
+                      << "Model:" << std::endl << model_ << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool
+    is_gradient_of(std::string const & _primitive,
+                   std::string const & _gradient,
+                   ast::symbols const & _wrts)
+    {
+        return is_generated([&] (ast::entry_definition const & _entry, ast::symbol const & _name) { return transform::gradient(_entry, _wrts, _name); },
+                            _primitive, _gradient);
+    }
+
     void
     test_scalars()
     {
@@ -192,6 +235,16 @@ class test
                                "function a{x}() local z, z{x} = 1, 0 return z{x} / sqrt(one - sqr(z)) end "));
         assert(is_primitive_of("function a() local z = 1 return arccos(z) end ",
                                "function a{x}() local z, z{x} = 1, 0 return -(z{x} / sqrt(one - sqr(z))) end "));
+        assert(is_primitive_of("function a() local z = 1 return abs(z) end ",
+                               "function a{x}() local z, z{x} = 1, 0 return sign(z) * z{x} end "));
+        assert(is_primitive_of("function a() local z, t = 1, 1 return sumsqr(z, t) end ",
+                               "function a{x}() local z, t, z{x}, t{x} = 1, 1, 0, 0 return twice(z * z{x} + t * t{x}) end "));
+        assert(is_primitive_of("function a() local z, t = 1, 1 return max(z, t) end ",
+                               "function a{x}() local z, t, z{x}, t{x} = 1, 1, 0, 0 return pickmax(z, z{x}, t, t{x}) end "));
+        assert(is_primitive_of("function a() local z, t = 1, 1 return min(z, t) end ",
+                               "function a{x}() local z, t, z{x}, t{x} = 1, 1, 0, 0 return pickmin(z, z{x}, t, t{x}) end "));
+        assert(is_primitive_of("function a() local z, t = 1, 1 return pickmin(z, t, t, z) end ",
+                               "function a{x}() local z, t, z{x}, t{x} = 1, 1, 0, 0 return pickmin(z, t{x}, t, z{x}) end "));
     }
 
     void
@@ -335,6 +388,178 @@ class test
         {{"a"}, {"r"}, {"m"}}, true));
     }
 
+    void
+    test_gradient()
+    {
+        assert(is_gradient_of("function f(x, y) return x * y end ",
+                              "function g(x, y) local _t0 = x * y return _t0, one * y, one * x end ",
+                              {{"x"}, {"y"}}));
+        assert(is_gradient_of("function f(x) local s = sin(x) return s * s end ",
+                              "function g(x) local _t0 = sin(x) local _t1 = _t0 * _t0 local _a0 = one * _t0 + one * _t0 return _t1, _a0 * (cos(x) * (one)) end ",
+                              {{"x"}}));
+        assert(is_gradient_of("function f() return -a end ",
+                              "function g() local _t0 = -a return _t0, one * (-one), zero end ",
+                              {{"a"}, {"b"}}));
+        assert(is_gradient_of("function f(x) local s = x s *= x return s end ",
+                              "function g(x) local _t0 = x * x return _t0, one * x + one * x end ",
+                              {{"x"}}));
+    }
+
+    void
+    test_fused_jacobian()
+    {
+        auto const fused_jacobian = [] (ast::symbols const & _wrts, size_type const _output_limit, ast::symbols const & _spill)
+        {
+            return [=] (ast::entry_definition const & _entry, ast::symbol const & _name) { return transform::Jacobian(_entry, _wrts, _name, _output_limit, _spill); };
+        };
+        assert(is_generated(fused_jacobian({{"x"}, {"y"}}, 8, {}),
+                            "function f(x, y) return x * y end ",
+                            "function J(x, y) local _t0 = x * y local _d0 = y * one local _d1 = x * one return _t0, _d0, _d1 end "));
+        assert(is_generated(fused_jacobian({{"x"}, {"y"}}, 2, {{"j"}}),
+                            "function f(x, y) return x * y end ",
+                            "function J(x, y) local _t0 = x * y local _d0 = y * one local _d1 = x * one j = _d1 return _t0, _d0 end "));
+        assert(is_generated(fused_jacobian({{"x"}, {"z"}}, 8, {}),
+                            "function f(x) return sin(x), x end ",
+                            "function J(x) local _t0 = sin(x) local _d0 = (cos(x) * (one)) * one return _t0, x, _d0, one, zero, zero end "));
+        assert(is_generated(fused_jacobian({{"x"}, {"y"}}, 8, {}),
+                            "function f(x, y) return sqr(x), sqr(y) end ",
+                            "function J(x, y) local _t0 = sqr(x) local _t1 = sqr(y) local _d0 = (twice(x) * (one)) * one local _d1 = (twice(y) * (one)) * one return _t0, _t1, _d0, zero, zero, _d1 end "));
+    }
+
+    void
+    test_dual()
+    {
+        auto const dual = [] (std::deque< ast::symbols > const & _directions)
+        {
+            return [=] (ast::entry_definition const & _entry, ast::symbol const & _name) { return transform::dual(_entry, {{"x"}, {"y"}}, _directions, _name); };
+        };
+        assert(is_generated(dual({{{"u"}, {"v"}}}),
+                            "function f(x, y) return x * y end ",
+                            "function D(x, y, u, v) local _t0 = x * y local _d0 = y * u + x * v return _t0, _d0 end "));
+        assert(is_generated(dual({{{"u1"}, {"u2"}}, {{"w1"}, {"w2"}}}),
+                            "function f(x, y) return x * y, x end ",
+                            "function D(x, y, u1, u2, w1, w2) local _t0 = x * y local _d0 = y * u1 + x * u2 local _d1 = y * w1 + x * w2 return _t0, x, _d0, u1, _d1, w1 end "));
+    }
+
+    void
+    test_sparsity()
+    {
+        auto const ast_ = parse("function g(a, b) return a, sqr(b) end "
+                                "function f(x, y, z) local u, v = g(x, y) return u * z, v + c end ");
+        assert(ast_);
+        ast::program const program_ = transform::evaluate(*ast_);
+        ast::symbols const wrts_ = {{"x"}, {"y"}, {"z"}, {"w"}, {"c"}};
+        transform::sparsity_pattern const sparsity_pattern_ = transform::get_sparsity_pattern(program_, {"f"}, wrts_);
+        assert((sparsity_pattern_ == transform::sparsity_pattern{{0, 2}, {1, 4}}));
+        transform::column_colouring const column_colouring_ = transform::colour_columns(sparsity_pattern_, wrts_.size());
+        assert((column_colouring_ == transform::column_colouring{0, 0, 1, 0, 1}));
+    }
+
+    void
+    test_canonicalization()
+    {
+        assert(is_primitive_of("function a() return x * x end ",
+                               "function a{x}() return 2 * x end "
+                               "function a{x, x}() return 2 end ",
+        {{"x"}, {"x"}}));
+        assert(is_primitive_of("function a() return x * y * x end ",
+                               "function a{x}() return 2 * (y * x) end ",
+        {{"x"}}));
+    }
+
+    void
+    test_derivative_cache()
+    {
+        auto const ast_ = parse("function b(t) return sqr(t) end "
+                                "function a(t) return b(t) end ");
+        assert(ast_);
+        ast::program const program_ = transform::evaluate(*ast_);
+        transform::derivative_cache cache_{program_};
+        ast::program const first_ = transform::derive(cache_, {{"a"}}, {{"x"}});
+        assert(first_.entries_.size() == 2);
+        assert(cache_.size() == 2);
+        ast::program const second_ = transform::derive(cache_, {{"a"}, {"b"}}, {{"x"}});
+        assert(cache_.size() == 2);
+        using namespace std::rel_ops;
+        assert(first_ == second_);
+        ast::program const mixed_ = transform::derive(cache_, {{"a"}}, {{"x"}, {"y"}});
+        assert(cache_.size() == 4);
+        assert(mixed_.entries_.size() == 4);
+        assert(mixed_ == transform::derive(program_, {{"a"}}, {{"x"}, {"y"}}));
+    }
+
+    void
+    test_hessian()
+    {
+        auto const ast_ = parse("function f() return a * b end ");
+        assert(ast_);
+        auto const model_ = parse("function f{a}() return b end "
+                                  "function f{a, a}() return zero end "
+                                  "function f{a, b}() return one end "
+                                  "function f{b}() return a end "
+                                  "function f{b, b}() return zero end ");
+        assert(model_);
+        ast::program const program_ = transform::evaluate(*ast_);
+        ast::program const hessian_ = transform::Hessian(program_, {{"a"}, {"b"}});
+        using namespace std::rel_ops;
+        if (hessian_ != transform::evaluate(*model_)) {
+            std::cerr << "Hessian:" << std::endl << hessian_ << std::endl;
+            assert(false);
+        }
+        transform::derivative_cache cache_{program_};
+        assert(transform::Hessian(cache_, {{"a"}, {"b"}}) == hessian_);
+        assert(cache_.size() == hessian_.entries_.size());
+        auto const hessian_vector_product = [] (ast::entry_definition const & _entry, ast::symbol const & _name)
+        {
+            return transform::Hessian_vector_product(_entry, {{"x"}, {"y"}}, {{"u"}, {"v"}}, _name);
+        };
+        assert(is_generated(hessian_vector_product,
+                            "function f(x, y) return x * y end ",
+                            "function H(x, y, u, v) local _t1 = x * y local _d0 = y * u + x * v return _t1, y, x, v, u end "));
+    }
+
+    void
+    test_parallel()
+    {
+        auto const ast_ = parse("function c(t) return sqr(t) * x end "
+                                "function b(t) return c(t) + y * t end "
+                                "function a(t) return b(t) * c(x) end "
+                                "function d() return a(y) - x * y end ");
+        assert(ast_);
+        ast::program const program_ = transform::evaluate(*ast_);
+        assert(transform::evaluate_parallel(*ast_, 3) == program_);
+        assert(transform::evaluate_parallel(ast::program(*ast_), 3) == program_);
+        ast::symbols const targets_ = {{"d"}, {"a"}, {"b"}};
+        ast::symbols const wrts_ = {{"x"}, {"y"}};
+        assert(transform::derive_parallel(program_, targets_, wrts_, 4) == transform::derive(program_, targets_, wrts_));
+        {
+            transform::derivative_cache sequential_{program_};
+            transform::derivative_cache parallel_{program_};
+            assert(transform::derive(sequential_, {{"b"}}, {{"x"}}) == transform::derive_parallel(parallel_, {{"b"}}, {{"x"}}, 2));
+            assert(transform::derive(sequential_, targets_, wrts_) == transform::derive_parallel(parallel_, targets_, wrts_, 4));
+            assert(parallel_.size() == sequential_.size());
+            assert(parallel_.release() == sequential_.release());
+        }
+        { // derivations sharing a cache
+            transform::derivative_cache shared_{program_};
+            transform::derivative_cache x_cache_{program_};
+            transform::derivative_cache y_cache_{program_};
+            auto x_ = std::async(std::launch::async, [&] { return transform::derive_parallel(shared_, targets_, {{"x"}}, 2); });
+            auto y_ = std::async(std::launch::async, [&] { return transform::derive(shared_, targets_, {{"y"}}); });
+            assert(x_.get() == transform::derive(x_cache_, targets_, {{"x"}}));
+            assert(y_.get() == transform::derive(y_cache_, targets_, {{"y"}}));
+            assert(shared_.size() == x_cache_.size() + y_cache_.size());
+        }
+        ast::symbols const columns_ = {{"x"}, {"y"}, {"x"}};
+        ast::programs const jacobian_ = transform::Jacobian(program_, columns_);
+        assert(transform::Jacobian_parallel(program_, columns_, 3) == jacobian_);
+        {
+            transform::derivative_cache cache_{program_};
+            assert(transform::Jacobian_parallel(cache_, columns_, 4) == jacobian_);
+            assert(transform::Jacobian(cache_, columns_) == jacobian_);
+        }
+    }
+
 public:
 
     bool
@@ -350,6 +575,14 @@ public:
         test_mixed_partial_derivative();
         test_dependent_recursive();
         test_jacobian();
+        test_gradient();
+        test_fused_jacobian();
+        test_dual();
+        test_sparsity();
+        test_canonicalization();
+        test_derivative_cache();
+        test_hessian();
+        test_parallel();
         std::cout << "Success!" << std::endl;
         return true;
     } catch (std::exception const & _exception) {
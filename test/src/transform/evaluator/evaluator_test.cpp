@@ -1,4 +1,5 @@
 #include <insituc/transform/evaluator/expression.hpp>
+#include <insituc/transform/evaluator/precedence.hpp>
 #include <insituc/floating_point_type.hpp>
 
 #include <insituc/base_types.hpp>
@@ -385,6 +386,16 @@ class test
         assert(is_reduceable(ast::intrinsic::abs, {I{ast::intrinsic::sqr, {{a_}}}}, I{ast::intrinsic::sqr, {{a_}}}));
         assert(is_reduceable(ast::intrinsic::abs, {I{ast::intrinsic::sumsqr, {{a_, ast::constant::l2e}}}}, I{ast::intrinsic::sumsqr, {{a_, ast::constant::l2e}}}));
 
+        assert(is_reduceable(ast::intrinsic::sign, {G(-3)}, -one));
+        assert(is_reduceable(ast::intrinsic::sign, {ast::constant::zero}, zero));
+        assert(is_immutable(ast::intrinsic::sign, {ast::constant::l2t}));
+        assert(is_reduceable(ast::intrinsic::sign, {I{ast::intrinsic::sign, {{a_}}}}, I{ast::intrinsic::sign, {{a_}}}));
+        {
+            O const sign_ = transform::evaluate(O{invoke(ast::intrinsic::sign, {std::numeric_limits< G >::quiet_NaN()})});
+            G const * const value_ = get< G >(&sign_);
+            assert(value_ && isnan(*value_)); // as compiled code yields
+        }
+
         assert(is_reduceable(ast::intrinsic::twice, {ast::constant::one}, G(2)));
         assert(is_immutable(ast::intrinsic::twice, {ast::constant::l2t}));
         assert(is_reduceable(ast::intrinsic::twice, {U{ast::unary::minus, a_}}, U{ast::unary::minus, I{ast::intrinsic::twice, {{a_}}}}));
@@ -663,6 +674,10 @@ class test
         assert(is_immutable(ast::intrinsic::max, {ast::constant::ln2, one}));
         assert(is_reduceable(ast::intrinsic::max, {one, ast::constant::ln2}, I{ast::intrinsic::max, {{ast::constant::ln2, one}}}));
         assert(is_reduceable(ast::intrinsic::min, {G(2), G(-2), zero}, G(-2)));
+        assert(is_reduceable(ast::intrinsic::pickmax, {G(2), a_, G(3), b_, G(3), c_}, b_));
+        assert(is_reduceable(ast::intrinsic::pickmin, {G(2), a_, G(3), b_, G(2), c_}, a_));
+        assert(is_reduceable(ast::intrinsic::pickmin, {G(2), a_, std::numeric_limits< G >::quiet_NaN(), b_, G(1), c_}, c_)); // NaN is never picked
+        assert(is_immutable(ast::intrinsic::pickmax, {G(2), a_, b_, c_}));
         assert(is_immutable(ast::intrinsic::min, {ast::constant::ln2, ast::constant::l2t, ast::constant::lg2}));
         assert(is_immutable(ast::intrinsic::min, {ast::constant::ln2, one}));
         assert(is_reduceable(ast::intrinsic::min, {one, ast::constant::ln2}, I{ast::intrinsic::min, {{ast::constant::ln2, one}}}));
@@ -765,6 +780,25 @@ class test
         assert(is_reduceable(E{G(3), {{ast::binary::sub, G(2)}, {ast::binary::sub, G(1)}}}, zero));
     }
 
+    void
+    test_precedence_resolution()
+    {
+        N a_;
+        a_.symbol_ = S{"a"};
+        N b_;
+        b_.symbol_ = S{"b"};
+        N c_;
+        c_.symbol_ = S{"c"};
+        N d_;
+        d_.symbol_ = S{"d"};
+        E const e_{a_, {{ast::binary::add, b_}, {ast::binary::mul, c_}, {ast::binary::sub, d_}, {ast::binary::pow, G(2)}, {ast::binary::div, a_}}};
+        O const resolved_ = transform::resolve_precedence(e_);
+        assert(resolved_ == O{B{B{a_, ast::binary::add, B{b_, ast::binary::mul, c_}}, ast::binary::sub, B{B{d_, ast::binary::pow, G(2)}, ast::binary::div, a_}}});
+        E const nested_{I{ast::intrinsic::sin, {{E{a_, {{ast::binary::sub, b_}, {ast::binary::div, c_}}}}}}, {{ast::binary::mul, d_}}};
+        assert(transform::resolve_precedence(nested_) == O{B{I{ast::intrinsic::sin, {{B{a_, ast::binary::sub, B{b_, ast::binary::div, c_}}}}}, ast::binary::mul, d_}});
+        assert(transform::resolve_precedence(E{a_, {}}) == O{a_});
+    }
+
     void
     test_unary_expression_branches()
     {
@@ -875,6 +909,7 @@ public:
         test_unary_expression();
         test_intrinsic();
         test_expression();
+        test_precedence_resolution();
         test_unary_expression_branches();
         test_expression_branches();
         std::cout << "Success!" << std::endl;
@@ -0,0 +1,340 @@
+#include <insituc/transform/optimizer/cse.hpp>
+#include <insituc/transform/optimizer/specialize.hpp>
+#include <insituc/transform/optimizer/strength_reduction.hpp>
+#include <insituc/transform/optimizer/trigonometry.hpp>
+#include <insituc/transform/optimizer/canonicalize.hpp>
+#include <insituc/transform/optimizer/range.hpp>
+#include <insituc/transform/optimizer/interprocedural.hpp>
+#include <insituc/transform/evaluator/evaluator.hpp>
+
+#include <insituc/ast/io.hpp>
+#include <insituc/ast/compare.hpp>
+#include <insituc/parser/parser.hpp>
+
+#include <experimental/optional>
+
+#include <utility>
+#include <iterator>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+#include <insituc/debug/demangle.hpp>
+#include <typeinfo>
+#include <cxxabi.h>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmissing-field-initializers"
+namespace
+{
+
+using namespace std::string_literals;
+
+using namespace insituc;
+
+class test
+{
+
+    std::experimental::optional< ast::program >
+    parse(std::string const & _source) const
+    {
+        auto parse_result_ = parser::parse(std::cbegin(_source), std::cend(_source));
+        if (!!parse_result_.error_) {
+            auto const & error_description_ = *parse_result_.error_;
+            std::cerr << "Error: \"" << error_description_.which_
+                      << "\" at input position: ";
+            std::copy(error_description_.where_, error_description_.last_, std::ostreambuf_iterator< char_type >(std::cerr));
+            std::cerr << std::endl;
+            return {};
+        }
+        return std::move(parse_result_.ast_);
+    }
+
+    template< typename pass >
+    bool
+    is_optimized_to(pass && _pass,
+                    std::string const & _source,
+                    std::string const & _model)
+    {
+        auto const source_ = parse(_source);
+        if (!source_) {
+            std::cerr << "Can't parse _source" << std::endl;
+            return false;
+        }
+        auto const model_ = parse(_model);
+        if (!model_) {
+            std::cerr << "Can't parse _model" << std::endl;
+            return false;
+        }
+        ast::program const result_ = transform::evaluate(std::forward< pass >(_pass)(transform::evaluate(*source_)));
+        ast::program const evaluated_model_ = transform::evaluate(*model_);
+        using namespace std::rel_ops;
+        if (result_ != evaluated_model_) {
+            std::cerr << "Result does not match the model." << std::endl
+                      << "Source:" << std::endl << *source_ << std::endl
+                      << "Result:" << std::endl << result_ << std::endl
+                      << "Model:" << std::endl << evaluated_model_ << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void
+    test_common_subexpressions()
+    {
+        auto const cse = [] (ast::program const & _program) { return transform::eliminate_common_subexpressions(_program); };
+        assert(is_optimized_to(cse,
+                               "function f(x) return sin(x) * cos(x) + sin(x) end ",
+                               "function f(x) local _cse0 = sin(x) return _cse0 * cos(x) + _cse0 end "));
+        assert(is_optimized_to(cse,
+                               "function f(x) return x, x end ",
+                               "function f(x) return x, x end "));
+        assert(is_optimized_to(cse,
+                               "function f(x, y) local a = sqr(x + y) return sqr(x + y) * a end ",
+                               "function f(x, y) local _cse0 = sqr(x + y) local a = _cse0 return _cse0 * a end "));
+        assert(is_optimized_to(cse,
+                               "function f(x) local a = sqrt(x) x = one return sqrt(x) + a end ",
+                               "function f(x) local a = sqrt(x) x = one return sqrt(x) + a end "));
+        assert(is_optimized_to(cse,
+                               "function f(x, y) local a = sqrt(x) y = one return sqrt(x) + a + y end ",
+                               "function f(x, y) local _cse0 = sqrt(x) local a = _cse0 y = one return _cse0 + a + y end "));
+        assert(is_optimized_to(cse,
+                               "function f(_cse0) begin local a = exp(_cse0) end return exp(_cse0) end ",
+                               "function f(_cse0) begin local a = exp(_cse0) end return exp(_cse0) end "));
+        assert(is_optimized_to(cse,
+                               "function f(_cse0) begin local a = exp(_cse0) local b = exp(_cse0) end return exp(_cse0) end ",
+                               "function f(_cse0) begin local _cse1 = exp(_cse0) local a = _cse1 local b = _cse1 end return exp(_cse0) end "));
+        assert(is_optimized_to(cse,
+                               "function f(x) local a = exp(x) begin local b = exp(x) end return exp(x) end ",
+                               "function f(x) local _cse0 = exp(x) local a = _cse0 begin local b = _cse0 end return _cse0 end "));
+    }
+
+    void
+    test_specialization()
+    {
+        transform::frozen_variables frozen_variables_;
+        {
+            ast::identifier g_;
+            g_.symbol_.name_ = "g";
+            frozen_variables_.emplace(std::move(g_), G(3));
+        }
+        auto const specialize = [&] (ast::program const & _program) { return transform::specialize(_program, frozen_variables_); };
+        assert(is_optimized_to(specialize,
+                               "function f(x) return x * sqr(g) + max(g, h) end ",
+                               "function f(x) return x * 9 + max(3, h) end "));
+        assert(is_optimized_to(specialize,
+                               "function f(g) return g end ",
+                               "function f(g) return g end "));
+        assert(is_optimized_to(specialize,
+                               "function f() begin local g = 1 end return g end ",
+                               "function f() begin local g = 1 end return 3 end "));
+        bool thrown_ = false;
+        try {
+            is_optimized_to(specialize, "function f() g = 1 return g end ", "function f() return 1 end ");
+        } catch (std::runtime_error const &) {
+            thrown_ = true;
+        }
+        assert(thrown_);
+    }
+
+    void
+    test_strength_reduction()
+    {
+        auto const reduce_strength = [] (ast::program const & _program) { return transform::reduce_strength(_program); };
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x) return x ^ 3 end ",
+                               "function f(x) return x * sqr(x) end "));
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x) return [[ fast_math = 0 ]] x ^ 3 end ",
+                               "function f(x) return [[ fast_math = 0 ]] x ^ 3 end "));
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x, y) return [[ fast_math = 1 ]] x ^ 3, exp(x) * exp(y), pow2(x) / pow2(y), x + x, x * x, y / 4 end ",
+                               "function f(x, y) return [[ fast_math = 1 ]] x ^ 3, exp(x) * exp(y), pow2(x) / pow2(y), twice(x), sqr(x), y * 0.25 end "));
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x) return pow(x, 4) end ",
+                               "function f(x) return sqr(sqr(x)) end "));
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x) return x ^ -2 end ",
+                               "function f(x) return 1 / sqr(x) end "));
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x) return x ^ 0.5 end ",
+                               "function f(x) return sqrt(x) end "));
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x) return x ^ 2.5 end ",
+                               "function f(x) return x ^ 2.5 end "));
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x) return x / 3 end ",
+                               "function f(x) return x / 3 end "));
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x, y) return exp(x) * exp(y), pow2(x) / pow2(y) end ",
+                               "function f(x, y) return exp(x + y), pow2(x - y) end "));
+        assert(is_optimized_to(reduce_strength,
+                               "function f(x) return x + x, x * x end ",
+                               "function f(x) return twice(x), sqr(x) end "));
+    }
+
+    void
+    test_trigonometric_pairs()
+    {
+        auto const pair_trigonometric_functions = [] (ast::program const & _program) { return transform::pair_trigonometric_functions(_program); };
+        assert(is_optimized_to(pair_trigonometric_functions,
+                               "function f(a, x, y) return x * cos(a) - y * sin(a), x * sin(a) + y * cos(a) end ",
+                               "function f(a, x, y) local _sin0, _cos0 = sincos(a) return x * _cos0 - y * _sin0, x * _sin0 + y * _cos0 end "));
+        assert(is_optimized_to(pair_trigonometric_functions,
+                               "function f(x) return tg(x) + ctg(x) end ",
+                               "function f(x) local _tg0 = tg(x) return _tg0 + 1 / _tg0 end "));
+        assert(is_optimized_to(pair_trigonometric_functions,
+                               "function f(x) return sin(x) + cos(2 * x), tg(x) end ",
+                               "function f(x) return sin(x) + cos(2 * x), tg(x) end "));
+        assert(is_optimized_to(pair_trigonometric_functions,
+                               "function f(x) local s = sin(x) x = one return s + cos(x) + sin(x) end ",
+                               "function f(x) local s = sin(x) x = one local _sin0, _cos0 = sincos(x) return s + _cos0 + _sin0 end "));
+    }
+
+    void
+    test_canonicalization()
+    {
+        auto const canonicalize = [] (ast::program const & _program) { return transform::canonicalize(_program); };
+        auto const cancel = [] (ast::program const & _program) { return transform::canonicalize(_program, true); };
+        assert(is_optimized_to(canonicalize,
+                               "function f(x, y) return x * y * x + 3 * x - x + 1 + 2 end ",
+                               "function f(x, y) return sqr(x) * y + 3 * x - x + 3 end "));
+        assert(is_optimized_to(cancel,
+                               "function f(x, y) return x * y * x + 3 * x - x + 1 + 2 end ",
+                               "function f(x, y) return sqr(x) * y + 2 * x + 3 end "));
+        assert(is_optimized_to(canonicalize,
+                               "function f(x, y) return x * y - y * x, x / y * y end ",
+                               "function f(x, y) return x * y - y * x, x / y * y end "));
+        assert(is_optimized_to(cancel,
+                               "function f(x, y) return x * y - y * x, x / y * y end ",
+                               "function f(x, y) return 0, x end "));
+        assert(is_optimized_to(canonicalize,
+                               "function f(x, y) return 3 * sqr(2 * y), 3 * sqr(twice(y)), 3 * sqr(-y), y / sqr(-x) end ",
+                               "function f(x, y) return 12 * sqr(y), 12 * sqr(y), 3 * sqr(y), y / sqr(x) end "));
+        assert(is_optimized_to(canonicalize,
+                               "function f(x, y) return x / sqr(2 * y), x / (sqr(twice(y)) * 2) end ",
+                               "function f(x, y) return 0.25 * x / sqr(y), 0.125 * x / sqr(y) end "));
+        assert(is_optimized_to(canonicalize,
+                               "function f(x, y) return x * y + y, z{x} / twice(sqrt(z)) end ",
+                               "function f(x, y) return x * y + y, z{x} / twice(sqrt(z)) end "));
+    }
+
+    void
+    test_range_lowering()
+    {
+        transform::variable_ranges declared_ranges_;
+        {
+            ast::identifier g_;
+            g_.symbol_.name_ = "g";
+            declared_ranges_.emplace(std::move(g_), transform::interval{zero, G(0.25)});
+        }
+        auto const lower_intrinsics = [&] (ast::program const & _program) { return transform::lower_intrinsics(_program, declared_ranges_); };
+        assert(is_optimized_to(lower_intrinsics,
+                               "function f(x) local y = g - 1 return abs(sqr(x)), abs(x), abs(y) end ",
+                               "function f(x) local y = g - 1 return sqr(x), abs(x), -y end "));
+        assert(is_optimized_to(lower_intrinsics,
+                               "function f(x) return ln(1 + g), log2(g + 1), lg(1 + x) end ",
+                               "function f(x) return yl2xp1(g, ln2), yl2xp1(g, 1), lg(1 + x) end "));
+        assert(is_optimized_to(lower_intrinsics,
+                               "function f(x) local s = sin(x) return pow2(s), pow2(x), exp(g) end ",
+                               "function f(x) local s = sin(x) return pow2m1(s) + 1, pow2(x), pow2m1(l2e * g) + 1 end "));
+        assert(is_optimized_to(lower_intrinsics,
+                               "function f(g) local s = sin(g) s = twice(s) return abs(g), pow2(s) end ",
+                               "function f(g) local s = sin(g) s = twice(s) return abs(g), pow2(s) end "));
+        assert(is_optimized_to(lower_intrinsics,
+                               "function f() return [[ fast_math = 1 ]] abs(sqr(g)), ln(1 + g), pow2(g) end ",
+                               "function f() return [[ fast_math = 1 ]] sqr(g), ln(1 + g), pow2(g) end "));
+        assert(is_optimized_to(lower_intrinsics,
+                               "function f() return [[ fast_math = 0 ]] abs(sqr(g)), exp(g) end ",
+                               "function f() return [[ fast_math = 0 ]] abs(sqr(g)), exp(g) end "));
+        bool thrown_ = false;
+        try {
+            is_optimized_to(lower_intrinsics, "function f() g = 1 return g end ", "function f() return 1 end ");
+        } catch (std::runtime_error const &) {
+            thrown_ = true;
+        }
+        assert(thrown_);
+    }
+
+    void
+    test_call_folding()
+    {
+        auto const fold_calls = [] (ast::program const & _program) { return transform::fold_calls(_program); };
+        assert(is_optimized_to(fold_calls,
+                               "function sq(x) local y = x * x begin y += 1 end return y end function f(a) return sq(3) + a, sq(a) end ",
+                               "function sq(x) local y = x * x begin y += 1 end return y end function f(a) return 10 + a, sq(a) end "));
+        assert(is_optimized_to(fold_calls,
+                               "function two(x) return x, x + 1 end function f(a) local b, c = two(2) return b * c * a end ",
+                               "function two(x) return x, x + 1 end function f(a) local b, c = 2, 3 return b * c * a end "));
+        assert(is_optimized_to(fold_calls, // globals are not constants
+                               "function h() return g * 2 end function k() return h() end ",
+                               "function h() return g * 2 end function k() return h() end "));
+        assert(is_optimized_to(fold_calls,
+                               "function h(x) g = x return x end function k() return h(1) end ",
+                               "function h(x) g = x return x end function k() return h(1) end "));
+        assert(is_optimized_to(fold_calls, // evaluation errors are left to runtime
+                               "function g(x) return 1 / x end function f() return g(0) end ",
+                               "function g(x) return 1 / x end function f() return g(0) end "));
+        assert(is_optimized_to([] (ast::program const & _program) { return transform::fold_calls(_program, 0); },
+                               "function sq(x) return x * x end function f() return sq(3) end ",
+                               "function sq(x) return x * x end function f() return sq(3) end "));
+        auto const source_ = parse("function p(x, n) return x ^ n end function q(x) return p(x, 2) + p(2 * x, 2) end ");
+        assert(!!source_);
+        ast::program const specialized_ = transform::fold_calls(transform::evaluate(*source_), 100, true);
+        assert(specialized_.entries_.size() == 3);
+        auto entry_ = std::next(std::cbegin(specialized_.entries_));
+        assert(entry_->entry_name_.symbol_.name_ == "p#0");
+        assert(entry_->argument_list_.lvalues_.size() == 1);
+        auto const signed_zeros_ = parse("function p(a, y) return atan2(a, -1) * y end function f(y) return p(0, y) + p(-0, y) end ");
+        assert(!!signed_zeros_);
+        ast::program const signed_zeros_specialized_ = transform::fold_calls(transform::evaluate(*signed_zeros_), 100, true);
+        assert(signed_zeros_specialized_.entries_.size() == 4); // one clone per sign of zero
+    }
+
+public:
+
+    bool
+    operator () ()
+    try {
+        test_common_subexpressions();
+        test_specialization();
+        test_strength_reduction();
+        test_trigonometric_pairs();
+        test_canonicalization();
+        test_range_lowering();
+        test_call_folding();
+        std::cout << "Success!" << std::endl;
+        return true;
+    } catch (std::exception const & _exception) {
+        std::cerr << "Exception raised: " << _exception.what() << std::endl;
+        return false;
+    } catch (...) {
+        if (std::type_info * et = abi::__cxa_current_exception_type()) {
+            std::cerr << "unhandled exception type: " << get_demangled_name(et->name()) << std::endl;
+        } else {
+            std::cerr << "unhandled unknown exception" << std::endl;
+        }
+        return false;
+    }
+
+};
+
+}
+#pragma clang diagnostic pop
+
+#include <cstdlib>
+
+int
+main()
+{
+    if (!test{}()) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}